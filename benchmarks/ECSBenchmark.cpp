@@ -0,0 +1,391 @@
+// Micro benchmarks for the ECS storage backends. Run the UniversalEngineBenchmarks target
+// in a Release build; an optional first argument overrides the entity count.
+
+#include "../src/Core/ECS/World.h"
+#include "../src/Core/Jobs/JobSystem.h"
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace UniversalEngine;
+
+namespace {
+    
+    class BenchPosition : public Component {
+    public:
+        BenchPosition(float x = 0.0f, float y = 0.0f) : x(x), y(y) {}
+        float x;
+        float y;
+    };
+    
+    class BenchVelocity : public Component {
+    public:
+        BenchVelocity(float x = 0.0f, float y = 0.0f) : x(x), y(y) {}
+        float x;
+        float y;
+    };
+    
+    class BenchCollider : public Component {
+    public:
+        BenchCollider(float halfWidth = 0.5f, float halfHeight = 0.5f) : halfWidth(halfWidth), halfHeight(halfHeight) {}
+        float halfWidth;
+        float halfHeight;
+    };
+    
+    // plain structs, so snapshots can copy their columns as raw bytes
+    struct BenchPodPosition {
+        float x;
+        float y;
+    };
+    
+    struct BenchPodVelocity {
+        float x;
+        float y;
+    };
+
+}
+
+namespace UniversalEngine {
+    template<> struct IsPODComponent<BenchPodPosition> : std::true_type {};
+    template<> struct IsPODComponent<BenchPodVelocity> : std::true_type {};
+}
+
+namespace {
+    
+    template<typename Func>
+    double MeasureMs(Func&& fn) {
+        auto start = std::chrono::steady_clock::now();
+        fn();
+        auto end = std::chrono::steady_clock::now();
+        return std::chrono::duration<double, std::milli>(end - start).count();
+    }
+    
+    void Report(const std::string& name, double ms) {
+        std::cout << "  " << name << ": " << ms << " ms" << std::endl;
+    }
+    
+    std::vector<Entity> Populate(World& world, size_t count) {
+        std::vector<Entity> entities;
+        entities.reserve(count);
+        
+        for (size_t i = 0; i < count; ++i) {
+            Entity entity = world.CreateEntity();
+            world.AddComponent(entity, BenchPosition(static_cast<float>(i), 0.0f));
+            world.AddComponent(entity, BenchVelocity(1.0f, 2.0f));
+            world.AddComponent(entity, BenchCollider());
+            entities.push_back(entity);
+        }
+        
+        world.ecs_flush();
+        return entities;
+    }
+    
+    // the access pattern Physics2DSystem uses today: HasComponent + GetComponent per type per entity
+    float IterateSparse(World& world, const std::vector<Entity>& entities, float deltaTime) {
+        float checksum = 0.0f;
+        for (Entity entity : entities) {
+            if (!world.HasComponent<BenchPosition>(entity) ||
+                !world.HasComponent<BenchVelocity>(entity) ||
+                !world.HasComponent<BenchCollider>(entity)) {
+                continue;
+            }
+            
+            auto& position = world.GetComponent<BenchPosition>(entity);
+            auto& velocity = world.GetComponent<BenchVelocity>(entity);
+            auto& collider = world.GetComponent<BenchCollider>(entity);
+            
+            position.x += velocity.x * deltaTime;
+            position.y += velocity.y * deltaTime;
+            checksum += position.x + collider.halfWidth;
+        }
+        return checksum;
+    }
+    
+    float IterateView(World& world, float deltaTime) {
+        float checksum = 0.0f;
+        world.View<BenchPosition, const BenchVelocity, const BenchCollider>().Each(
+            [&](Entity, BenchPosition& position, const BenchVelocity& velocity, const BenchCollider& collider) {
+                position.x += velocity.x * deltaTime;
+                position.y += velocity.y * deltaTime;
+                checksum += position.x + collider.halfWidth;
+            });
+        return checksum;
+    }
+    
+    float IterateArchetype(World& world, float deltaTime) {
+        float checksum = 0.0f;
+        world.ForEachChunk<BenchPosition, BenchVelocity, BenchCollider>(
+            [&](size_t count, const EntityID*, BenchPosition* positions, BenchVelocity* velocities, BenchCollider* colliders) {
+                for (size_t i = 0; i < count; ++i) {
+                    positions[i].x += velocities[i].x * deltaTime;
+                    positions[i].y += velocities[i].y * deltaTime;
+                    checksum += positions[i].x + colliders[i].halfWidth;
+                }
+            });
+        return checksum;
+    }
+    
+    float IterateGroup(World& world, float deltaTime) {
+        float checksum = 0.0f;
+        world.Group<BenchPosition, BenchVelocity, BenchCollider>().Each(
+            [&](Entity, BenchPosition& position, BenchVelocity& velocity, BenchCollider& collider) {
+                position.x += velocity.x * deltaTime;
+                position.y += velocity.y * deltaTime;
+                checksum += position.x + collider.halfWidth;
+            });
+        return checksum;
+    }
+    
+    // adds each component type in a different entity order, so the dense arrays disagree
+    // and a View has to chase the sparse index into random positions
+    void PopulateScrambled(World& world, size_t count) {
+        std::vector<Entity> entities;
+        entities.reserve(count);
+        for (size_t i = 0; i < count; ++i) {
+            entities.push_back(world.CreateEntity());
+        }
+        
+        for (size_t i = 0; i < count; ++i) {
+            world.AddComponent(entities[i], BenchPosition(static_cast<float>(i), 0.0f));
+            world.AddComponent(entities[count - 1 - i], BenchVelocity(1.0f, 2.0f));
+            world.AddComponent(entities[(i * 7919) % count], BenchCollider());
+        }
+        
+        world.ecs_flush();
+    }
+    
+    void BenchmarkGroups(size_t entityCount, int iterations) {
+        std::cout << "=== View vs owning group, " << entityCount << " entities, scrambled arrays ===" << std::endl;
+        
+        float checksum = 0.0f;
+        World world(ComponentStorage::SparseSet);
+        PopulateScrambled(world, entityCount);
+        
+        Report("View join (avg)", MeasureMs([&]() {
+            for (int i = 0; i < iterations; ++i) {
+                checksum += IterateView(world, 0.016f);
+            }
+        }) / iterations);
+        Report("group creation", MeasureMs([&]() { world.Group<BenchPosition, BenchVelocity, BenchCollider>(); }));
+        Report("group walk (avg)", MeasureMs([&]() {
+            for (int i = 0; i < iterations; ++i) {
+                checksum += IterateGroup(world, 0.016f);
+            }
+        }) / iterations);
+        
+        JobSystem jobSystem;
+        auto group = world.Group<BenchPosition, BenchVelocity, BenchCollider>();
+        Report("group ParallelEach, " + std::to_string(jobSystem.GetThreadCount()) + " threads (avg)", MeasureMs([&]() {
+            for (int i = 0; i < iterations; ++i) {
+                group.ParallelEach(jobSystem, [](Entity, BenchPosition& position, BenchVelocity& velocity, BenchCollider&) {
+                    position.x += velocity.x * 0.016f;
+                    position.y += velocity.y * 0.016f;
+                });
+            }
+        }) / iterations);
+        
+        std::cout << "  (checksum " << checksum << ")" << std::endl;
+    }
+    
+    void BenchmarkAlignment(size_t entityCount, int iterations) {
+        std::cout << "=== View join before/after AlignTo, " << entityCount << " entities, scrambled arrays ===" << std::endl;
+        
+        float checksum = 0.0f;
+        World world(ComponentStorage::SparseSet);
+        PopulateScrambled(world, entityCount);
+        
+        Report("scrambled View join (avg)", MeasureMs([&]() {
+            for (int i = 0; i < iterations; ++i) {
+                checksum += IterateView(world, 0.016f);
+            }
+        }) / iterations);
+        Report("AlignTo", MeasureMs([&]() { world.AlignTo<BenchPosition, BenchVelocity, BenchCollider>(); }));
+        Report("aligned View join (avg)", MeasureMs([&]() {
+            for (int i = 0; i < iterations; ++i) {
+                checksum += IterateView(world, 0.016f);
+            }
+        }) / iterations);
+        
+        std::cout << "  (checksum " << checksum << ")" << std::endl;
+    }
+    
+    void BenchmarkBulk(size_t entityCount) {
+        std::cout << "=== Spawn + destroy, " << entityCount << " entities x 2 components ===" << std::endl;
+        
+        {
+            World world;
+            std::vector<Entity> entities;
+            entities.reserve(entityCount);
+            Report("per entity    spawn + flush", MeasureMs([&]() {
+                for (size_t i = 0; i < entityCount; ++i) {
+                    Entity entity = world.CreateEntity();
+                    world.AddComponent(entity, BenchPosition());
+                    world.AddComponent(entity, BenchVelocity(1.0f, 2.0f));
+                    entities.push_back(entity);
+                }
+                world.ecs_flush();
+            }));
+            Report("per entity    destroy", MeasureMs([&]() {
+                for (Entity entity : entities) {
+                    world.DestroyEntity(entity);
+                }
+            }));
+        }
+        
+        {
+            World world;
+            std::vector<Entity> entities(entityCount);
+            Report("bulk          spawn + flush", MeasureMs([&]() {
+                world.CreateEntities(entityCount, entities);
+                world.AddComponents(Span<const Entity>(entities), BenchPosition());
+                world.AddComponents(Span<const Entity>(entities), BenchVelocity(1.0f, 2.0f));
+                world.ecs_flush();
+            }));
+            Report("bulk          destroy", MeasureMs([&]() { world.DestroyEntities(entities); }));
+        }
+        
+        {
+            World world;
+            Prefab prefab;
+            prefab.Set(BenchPosition()).Set(BenchVelocity(1.0f, 2.0f));
+            
+            std::vector<Entity> entities(entityCount);
+            Report("prefab        instantiate", MeasureMs([&]() { world.Instantiate(prefab, entityCount, entities); }));
+        }
+    }
+    
+    void BenchmarkSnapshot(size_t entityCount) {
+        std::cout << "=== Snapshot save + load, " << entityCount << " entities x 2 POD components ===" << std::endl;
+        
+        std::stringstream stream;
+        {
+            World world;
+            std::vector<Entity> entities(entityCount);
+            world.CreateEntities(entityCount, entities);
+            world.AddComponents(Span<const Entity>(entities), BenchPodPosition{ 0.0f, 0.0f });
+            world.AddComponents(Span<const Entity>(entities), BenchPodVelocity{ 1.0f, 2.0f });
+            world.ecs_flush();
+            
+            Report("save", MeasureMs([&]() { world.SaveSnapshot(stream); }));
+        }
+        
+        World world;
+        world.RegisterComponent<BenchPodPosition>();
+        world.RegisterComponent<BenchPodVelocity>();
+        Report("load", MeasureMs([&]() { world.LoadSnapshot(stream); }));
+        std::cout << "  (" << world.GetEntityCount() << " entities loaded)" << std::endl;
+    }
+    
+    void BenchmarkRollback(size_t entityCount, int frames) {
+        std::cout << "=== Rollback record + rewind, " << entityCount << " entities x 2 POD components ===" << std::endl;
+        
+        World world;
+        world.EnableRollback<BenchPodPosition, BenchPodVelocity>(frames);
+        std::vector<Entity> entities(entityCount);
+        world.CreateEntities(entityCount, entities);
+        world.AddComponents(Span<const Entity>(entities), BenchPodPosition{ 0.0f, 0.0f });
+        world.AddComponents(Span<const Entity>(entities), BenchPodVelocity{ 1.0f, 2.0f });
+        world.ecs_flush();
+        Report("first record", MeasureMs([&]() { world.RecordFrame(); }));
+        
+        Report("record, nothing changed (avg)", MeasureMs([&]() {
+            for (int i = 0; i < frames; ++i) {
+                world.RecordFrame();
+            }
+        }) / frames);
+        
+        // worst case: every position moves every frame
+        Report("record, all positions changed (avg)", MeasureMs([&]() {
+            for (int i = 0; i < frames; ++i) {
+                world.View<BenchPodPosition, const BenchPodVelocity>().Each(
+                    [](Entity, BenchPodPosition& position, const BenchPodVelocity& velocity) {
+                        position.x += velocity.x;
+                        position.y += velocity.y;
+                    });
+                world.RecordFrame();
+            }
+        }) / frames);
+        
+        Report("rewind all frames", MeasureMs([&]() { world.Rewind(frames - 1); }));
+    }
+    
+    void BenchmarkResources(int lookups) {
+        std::cout << "=== Global settings lookup, " << lookups << " reads ===" << std::endl;
+        
+        World world;
+        std::vector<Entity> entities(1000);
+        world.CreateEntities(entities.size(), entities);
+        Entity settingsEntity = world.CreateEntity();
+        world.AddComponent(settingsEntity, BenchPodVelocity{ 1.0f, 0.0f });
+        world.SetResource(BenchPodVelocity{ 1.0f, 0.0f });
+        world.ecs_flush();
+        
+        float checksum = 0.0f;
+        Report("component on a settings entity", MeasureMs([&]() {
+            for (int i = 0; i < lookups; ++i) {
+                checksum += world.GetComponent<BenchPodVelocity>(settingsEntity).x;
+            }
+        }));
+        Report("world resource", MeasureMs([&]() {
+            for (int i = 0; i < lookups; ++i) {
+                checksum += world.GetResource<BenchPodVelocity>().x;
+            }
+        }));
+        std::cout << "  (checksum " << checksum << ")" << std::endl;
+    }
+    
+    void BenchmarkStorage(size_t entityCount, int iterations) {
+        std::cout << "=== Storage backends, " << entityCount << " entities x 3 components ===" << std::endl;
+        
+        float checksum = 0.0f;
+        
+        {
+            World world(ComponentStorage::SparseSet);
+            std::vector<Entity> entities;
+            Report("sparse set    create + flush", MeasureMs([&]() { entities = Populate(world, entityCount); }));
+            Report("sparse set    3-way join (avg)", MeasureMs([&]() {
+                for (int i = 0; i < iterations; ++i) {
+                    checksum += IterateSparse(world, entities, 0.016f);
+                }
+            }) / iterations);
+            Report("sparse set    3-way View join (avg)", MeasureMs([&]() {
+                for (int i = 0; i < iterations; ++i) {
+                    checksum += IterateView(world, 0.016f);
+                }
+            }) / iterations);
+        }
+        
+        {
+            World world(ComponentStorage::Archetype);
+            Report("archetype     create + flush", MeasureMs([&]() { Populate(world, entityCount); }));
+            Report("archetype     3-way join (avg)", MeasureMs([&]() {
+                for (int i = 0; i < iterations; ++i) {
+                    checksum += IterateArchetype(world, 0.016f);
+                }
+            }) / iterations);
+        }
+        
+        std::cout << "  (checksum " << checksum << ")" << std::endl;
+    }
+
+}
+
+int main(int argc, char* argv[]) {
+    size_t entityCount = 100000;
+    if (argc > 1) {
+        entityCount = static_cast<size_t>(std::strtoul(argv[1], nullptr, 10));
+    }
+    
+    BenchmarkStorage(entityCount, 20);
+    BenchmarkGroups(entityCount, 20);
+    BenchmarkAlignment(entityCount, 20);
+    BenchmarkBulk(entityCount);
+    BenchmarkSnapshot(entityCount);
+    BenchmarkRollback(entityCount, 60);
+    BenchmarkResources(1000000);
+    
+    return 0;
+}
@@ -10,7 +10,7 @@
 
 namespace UniversalEngine {
 
-class BoxCollider2D : public Component {
+class BoxCollider2D {
 public:
     glm::vec2 size{1.0f, 1.0f};
     glm::vec2 offset{0.0f, 0.0f};
@@ -32,6 +32,8 @@ public:
     }
 };
 
+template<> struct IsPODComponent<BoxCollider2D> : std::true_type {};
+
 namespace detail {
 struct OBB {
     glm::vec2 c;
@@ -0,0 +1,18 @@
+#pragma once
+#include "../ECS/Component.h"
+#include "../ECS/Entity.h"
+
+namespace UniversalEngine {
+    
+    // Makes the entity's Transform2D local to another entity's world transform; see
+    // TransformHierarchySystem. An entity without one (or whose parent is gone) is a root.
+    struct Parent {
+        Entity entity;
+        
+        Parent() = default;
+        Parent(Entity parent) : entity(parent) {}
+    };
+    
+    template<> struct IsPODComponent<Parent> : std::true_type {};
+    
+}
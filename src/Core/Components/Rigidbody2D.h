@@ -4,7 +4,7 @@
 
 namespace UniversalEngine {
     
-    class Rigidbody2D : public Component {
+    class Rigidbody2D {
     public:
         glm::vec2 velocity{0.0f, 0.0f};
         
@@ -34,4 +34,6 @@ namespace UniversalEngine {
         }
     };
     
+    template<> struct IsPODComponent<Rigidbody2D> : std::true_type {};
+    
 }
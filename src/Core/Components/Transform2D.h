@@ -3,7 +3,7 @@
 #include <glm/glm.hpp>
 
 namespace UniversalEngine {
-    class Transform2D : public Component {
+    class Transform2D {
     public:
         glm::vec2 scale{1.0f};
         glm::vec2 position{0.0f};
@@ -13,4 +13,6 @@ namespace UniversalEngine {
         Transform2D(const glm::vec2& pos, const glm::vec2& scl = glm::vec2(1.0f), float rot = 0.0f)
             : position(pos), scale(scl), rotation(rot) {}
     };
+    
+    template<> struct IsPODComponent<Transform2D> : std::true_type {};
 }
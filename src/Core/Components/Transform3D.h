@@ -1,4 +1,5 @@
 #pragma once
+#include "../ECS/Component.h"
 #include <glm/glm.hpp>
 
 namespace UniversalEngine {
@@ -7,4 +8,6 @@ namespace UniversalEngine {
         glm::vec3 rotation{0.0f}; 
         glm::vec3 scale{1.0f};
     };
+    
+    template<> struct IsPODComponent<Transform3D> : std::true_type {};
 }
\ No newline at end of file
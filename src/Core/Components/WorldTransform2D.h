@@ -0,0 +1,17 @@
+#pragma once
+#include "../ECS/Component.h"
+#include <glm/glm.hpp>
+
+namespace UniversalEngine {
+    
+    // Transform2D composed with every ancestor's, as a column-major 2D affine matrix.
+    // Written by TransformHierarchySystem; add it to any entity whose world placement is needed.
+    struct WorldTransform2D {
+        glm::mat3 matrix{1.0f};
+        
+        glm::vec2 GetPosition() const { return glm::vec2(matrix[2].x, matrix[2].y); }
+    };
+    
+    template<> struct IsPODComponent<WorldTransform2D> : std::true_type {};
+    
+}
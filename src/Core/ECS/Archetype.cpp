@@ -0,0 +1,231 @@
+#include "Archetype.h"
+#include <cstring>
+
+namespace UniversalEngine {
+    
+    static std::size_t AlignUp(std::size_t offset, std::size_t alignment) {
+        return (offset + alignment - 1) & ~(alignment - 1);
+    }
+    
+    Archetype::Archetype(const Signature& signature, std::vector<const ComponentTypeInfo*> types)
+        : m_Signature(signature), m_Types(std::move(types)) {
+        m_ColumnLookup.fill(NO_COLUMN);
+        
+        std::size_t rowSize = sizeof(EntityID);
+        for (size_t i = 0; i < m_Types.size(); ++i) {
+            if (m_Types[i]->alignment > alignof(ChunkMemory)) {
+                throw std::runtime_error("Component alignment exceeds archetype chunk alignment");
+            }
+            rowSize += m_Types[i]->size;
+            m_ColumnLookup[m_Types[i]->id] = static_cast<std::uint16_t>(i);
+        }
+        
+        // shrink the row count until the aligned columns fit in one chunk
+        for (m_ChunkCapacity = CHUNK_SIZE / rowSize; m_ChunkCapacity > 0; --m_ChunkCapacity) {
+            m_ColumnOffsets.clear();
+            std::size_t offset = m_ChunkCapacity * sizeof(EntityID);
+            for (const ComponentTypeInfo* type : m_Types) {
+                offset = AlignUp(offset, type->alignment);
+                m_ColumnOffsets.push_back(offset);
+                offset += m_ChunkCapacity * type->size;
+            }
+            if (offset <= CHUNK_SIZE) {
+                break;
+            }
+        }
+        
+        if (m_ChunkCapacity == 0) {
+            throw std::runtime_error("Component set does not fit in an archetype chunk");
+        }
+    }
+    
+    Archetype::~Archetype() {
+        for (std::size_t row = 0; row < m_Size; ++row) {
+            for (const ComponentTypeInfo* type : m_Types) {
+                type->destroy(GetComponent(row, type->id));
+            }
+        }
+    }
+    
+    std::size_t Archetype::AllocateRow(EntityID entity) {
+        if (m_Size == m_Chunks.size() * m_ChunkCapacity) {
+            m_Chunks.push_back(std::make_unique<ChunkMemory>());
+        }
+        
+        std::size_t row = m_Size++;
+        GetEntities(row / m_ChunkCapacity)[row % m_ChunkCapacity] = entity;
+        return row;
+    }
+    
+    EntityID Archetype::RemoveRow(std::size_t row) {
+        for (const ComponentTypeInfo* type : m_Types) {
+            type->destroy(GetComponent(row, type->id));
+        }
+        
+        std::size_t last = m_Size - 1;
+        EntityID moved = INVALID_ENTITY;
+        
+        if (row != last) {
+            for (const ComponentTypeInfo* type : m_Types) {
+                void* source = GetComponent(last, type->id);
+                type->moveConstruct(GetComponent(row, type->id), source);
+                type->destroy(source);
+            }
+            moved = GetEntity(last);
+            GetEntities(row / m_ChunkCapacity)[row % m_ChunkCapacity] = moved;
+        }
+        
+        --m_Size;
+        
+        // keep one spare chunk around so an add/remove cycle at a chunk boundary does not thrash
+        if (m_Chunks.size() > GetChunkCount() + 1) {
+            m_Chunks.pop_back();
+        }
+        
+        return moved;
+    }
+    
+    void ArchetypeStorage::Commit(std::vector<EntityID>& touched) {
+        if (m_Staged.empty()) {
+            return;
+        }
+        
+        // group by entity, keeping the submission order of each entity's operations
+        std::stable_sort(m_Staged.begin(), m_Staged.end(),
+            [](const StagedOperation& a, const StagedOperation& b) {
+                return a.entity < b.entity;
+            });
+        
+        std::array<void*, MAX_COMPONENTS> sources;
+        
+        size_t i = 0;
+        while (i < m_Staged.size()) {
+            EntityID entity = m_Staged[i].entity;
+            Signature signature = GetSignature(entity);
+            sources.fill(nullptr);
+            
+            for (; i < m_Staged.size() && m_Staged[i].entity == entity; ++i) {
+                const StagedOperation& operation = m_Staged[i];
+                sources[operation.type] = operation.source;
+                if (operation.source) {
+                    signature.set(operation.type);
+                } else {
+                    signature.reset(operation.type);
+                }
+            }
+            
+            MoveEntity(entity, signature, sources);
+            touched.push_back(entity);
+        }
+        
+        m_Staged.clear();
+    }
+    
+    void ArchetypeStorage::DestroyEntity(EntityID entity) {
+        if (entity >= m_Locations.size() || !m_Locations[entity].archetype) {
+            return;
+        }
+        
+        EntityLocation& location = m_Locations[entity];
+        EntityID moved = location.archetype->RemoveRow(location.row);
+        if (moved != INVALID_ENTITY) {
+            m_Locations[moved].row = location.row;
+        }
+        location = EntityLocation();
+    }
+    
+    void ArchetypeStorage::InsertCopies(const Signature& signature, const EntityID* entities, std::size_t count,
+                                        const std::array<const void*, MAX_COMPONENTS>& prototypes) {
+        if (count == 0 || signature.none()) {
+            return;
+        }
+        
+        Archetype* archetype = GetOrCreateArchetype(signature);
+        std::size_t firstRow = archetype->Size();
+        
+        for (std::size_t i = 0; i < count; ++i) {
+            EntityID entity = entities[i];
+            if (entity >= m_Locations.size()) {
+                m_Locations.resize(entity + 1);
+            }
+            m_Locations[entity].archetype = archetype;
+            m_Locations[entity].row = archetype->AllocateRow(entity);
+        }
+        
+        // column by column, so each prototype stays hot while it is stamped out
+        for (const ComponentTypeInfo* type : archetype->GetTypes()) {
+            const void* prototype = prototypes[type->id];
+            for (std::size_t row = firstRow; row < firstRow + count; ++row) {
+                void* destination = archetype->GetComponent(row, type->id);
+                if (type->triviallyCopyable) {
+                    std::memcpy(destination, prototype, type->size);
+                } else {
+                    type->copyConstruct(destination, prototype);
+                }
+            }
+        }
+    }
+    
+    Archetype* ArchetypeStorage::GetOrCreateArchetype(const Signature& signature) {
+        auto it = m_ArchetypeLookup.find(signature);
+        if (it != m_ArchetypeLookup.end()) {
+            return it->second;
+        }
+        
+        std::vector<const ComponentTypeInfo*> types;
+        for (std::size_t type = 0; type < MAX_COMPONENTS; ++type) {
+            if (signature.test(type)) {
+                types.push_back(&m_TypeInfos[type]);
+            }
+        }
+        
+        m_Archetypes.push_back(std::make_unique<Archetype>(signature, std::move(types)));
+        Archetype* archetype = m_Archetypes.back().get();
+        m_ArchetypeLookup[signature] = archetype;
+        return archetype;
+    }
+    
+    void ArchetypeStorage::MoveEntity(EntityID entity, const Signature& signature,
+                                      const std::array<void*, MAX_COMPONENTS>& sources) {
+        if (entity >= m_Locations.size()) {
+            m_Locations.resize(entity + 1);
+        }
+        
+        EntityLocation& location = m_Locations[entity];
+        Archetype* source = location.archetype;
+        
+        // same component set: overwrite the re-added components in place
+        if (source && source->GetSignature() == signature) {
+            for (const ComponentTypeInfo* type : source->GetTypes()) {
+                if (sources[type->id]) {
+                    void* component = source->GetComponent(location.row, type->id);
+                    type->destroy(component);
+                    type->moveConstruct(component, sources[type->id]);
+                }
+            }
+            return;
+        }
+        
+        EntityLocation destination;
+        
+        if (signature.any()) {
+            destination.archetype = GetOrCreateArchetype(signature);
+            destination.row = destination.archetype->AllocateRow(entity);
+            
+            for (const ComponentTypeInfo* type : destination.archetype->GetTypes()) {
+                void* from = sources[type->id] ? sources[type->id] : source->GetComponent(location.row, type->id);
+                type->moveConstruct(destination.archetype->GetComponent(destination.row, type->id), from);
+            }
+        }
+        
+        if (source) {
+            EntityID moved = source->RemoveRow(location.row);
+            if (moved != INVALID_ENTITY) {
+                m_Locations[moved].row = location.row;
+            }
+        }
+        
+        location = destination;
+    }
+    
+}
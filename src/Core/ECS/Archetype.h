@@ -0,0 +1,185 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <memory>
+#include <vector>
+#include <array>
+#include <unordered_map>
+#include <algorithm>
+#include <stdexcept>
+#include "Entity.h"
+#include "Component.h"
+#include "Signature.h"
+
+namespace UniversalEngine {
+    
+    // all entities sharing one exact component set, packed into fixed-size chunks
+    // with one SoA column per component type plus an EntityID column
+    class Archetype {
+    public:
+        static constexpr std::size_t CHUNK_SIZE = 16 * 1024;
+        static constexpr std::uint16_t NO_COLUMN = 0xFFFF;
+        
+        Archetype(const Signature& signature, std::vector<const ComponentTypeInfo*> types);
+        ~Archetype();
+        
+        Archetype(const Archetype&) = delete;
+        Archetype& operator=(const Archetype&) = delete;
+        
+        const Signature& GetSignature() const { return m_Signature; }
+        const std::vector<const ComponentTypeInfo*>& GetTypes() const { return m_Types; }
+        
+        std::size_t Size() const { return m_Size; }
+        std::size_t GetChunkCapacity() const { return m_ChunkCapacity; }
+        std::size_t GetChunkCount() const { return (m_Size + m_ChunkCapacity - 1) / m_ChunkCapacity; }
+        
+        std::size_t GetChunkSize(std::size_t chunk) const {
+            std::size_t first = chunk * m_ChunkCapacity;
+            return std::min(m_ChunkCapacity, m_Size - first);
+        }
+        
+        bool HasColumn(ComponentTypeID type) const { return m_ColumnLookup[type] != NO_COLUMN; }
+        
+        // first element of a component column within a chunk
+        void* GetColumn(std::size_t chunk, ComponentTypeID type) {
+            return m_Chunks[chunk]->bytes + m_ColumnOffsets[m_ColumnLookup[type]];
+        }
+        
+        EntityID* GetEntities(std::size_t chunk) {
+            return reinterpret_cast<EntityID*>(m_Chunks[chunk]->bytes);
+        }
+        
+        void* GetComponent(std::size_t row, ComponentTypeID type) {
+            std::size_t column = m_ColumnLookup[type];
+            return m_Chunks[row / m_ChunkCapacity]->bytes + m_ColumnOffsets[column] +
+                   (row % m_ChunkCapacity) * m_Types[column]->size;
+        }
+        
+        EntityID GetEntity(std::size_t row) {
+            return GetEntities(row / m_ChunkCapacity)[row % m_ChunkCapacity];
+        }
+        
+        // appends a row with uninitialized component storage
+        std::size_t AllocateRow(EntityID entity);
+        
+        // destroys the row's components and swap-removes it against the last row;
+        // returns the entity that was moved into the hole, or INVALID_ENTITY
+        EntityID RemoveRow(std::size_t row);
+    
+    private:
+        struct alignas(64) ChunkMemory {
+            std::byte bytes[CHUNK_SIZE];
+        };
+        
+        Signature m_Signature;
+        std::vector<const ComponentTypeInfo*> m_Types;
+        std::vector<std::size_t> m_ColumnOffsets;
+        std::array<std::uint16_t, MAX_COMPONENTS> m_ColumnLookup;
+        
+        std::vector<std::unique_ptr<ChunkMemory>> m_Chunks;
+        std::size_t m_ChunkCapacity = 0;
+        std::size_t m_Size = 0;
+    };
+    
+    // archetype backend for World; structural changes are staged and applied in one
+    // archetype move per entity by Commit()
+    class ArchetypeStorage {
+    public:
+        ArchetypeStorage() = default;
+        
+        ArchetypeStorage(const ArchetypeStorage&) = delete;
+        ArchetypeStorage& operator=(const ArchetypeStorage&) = delete;
+        
+        template<typename T>
+        void RegisterType() {
+            RegisterType(ComponentTypeInfo::Of<T>());
+        }
+        
+        void RegisterType(const ComponentTypeInfo& typeInfo) {
+            m_TypeInfos[typeInfo.id] = typeInfo;
+            m_Registered.set(typeInfo.id);
+        }
+        
+        bool IsRegistered(ComponentTypeID type) const { return m_Registered.test(type); }
+        
+        bool Has(EntityID entity, ComponentTypeID type) const {
+            return entity < m_Locations.size() && m_Locations[entity].archetype &&
+                   m_Locations[entity].archetype->HasColumn(type);
+        }
+        
+        void* Get(EntityID entity, ComponentTypeID type) {
+            if (!Has(entity, type)) {
+                return nullptr;
+            }
+            const EntityLocation& location = m_Locations[entity];
+            return location.archetype->GetComponent(location.row, type);
+        }
+        
+        Signature GetSignature(EntityID entity) const {
+            if (entity >= m_Locations.size() || !m_Locations[entity].archetype) {
+                return Signature();
+            }
+            return m_Locations[entity].archetype->GetSignature();
+        }
+        
+        // source must stay alive until Commit(); it is moved from, not owned
+        void StageInsert(EntityID entity, ComponentTypeID type, void* source) {
+            m_Staged.push_back({ entity, type, source });
+        }
+        
+        void StageRemove(EntityID entity, ComponentTypeID type) {
+            m_Staged.push_back({ entity, type, nullptr });
+        }
+        
+        // applies staged operations; touched receives each entity whose components changed
+        void Commit(std::vector<EntityID>& touched);
+        
+        void DestroyEntity(EntityID entity);
+        
+        // places entities that have no components yet straight into signature's archetype,
+        // copying each column's prototype into every new row
+        void InsertCopies(const Signature& signature, const EntityID* entities, std::size_t count,
+                          const std::array<const void*, MAX_COMPONENTS>& prototypes);
+        
+        std::size_t GetArchetypeCount() const { return m_Archetypes.size(); }
+        
+        // calls fn(archetype, chunkIndex) for every non-empty chunk whose archetype contains required
+        template<typename Func>
+        void ForEachChunk(const Signature& required, Func&& fn) {
+            for (auto& archetype : m_Archetypes) {
+                if ((archetype->GetSignature() & required) != required) {
+                    continue;
+                }
+                std::size_t chunkCount = archetype->GetChunkCount();
+                for (std::size_t chunk = 0; chunk < chunkCount; ++chunk) {
+                    fn(*archetype, chunk);
+                }
+            }
+        }
+    
+    private:
+        struct EntityLocation {
+            Archetype* archetype = nullptr;
+            std::size_t row = 0;
+        };
+        
+        struct StagedOperation {
+            EntityID entity;
+            ComponentTypeID type;
+            void* source;
+        };
+        
+        Archetype* GetOrCreateArchetype(const Signature& signature);
+        void MoveEntity(EntityID entity, const Signature& signature, const std::array<void*, MAX_COMPONENTS>& sources);
+        
+        std::vector<std::unique_ptr<Archetype>> m_Archetypes;
+        std::unordered_map<Signature, Archetype*> m_ArchetypeLookup;
+        std::vector<EntityLocation> m_Locations;
+        
+        std::array<ComponentTypeInfo, MAX_COMPONENTS> m_TypeInfos;
+        Signature m_Registered;
+        
+        std::vector<StagedOperation> m_Staged;
+    };
+
+}
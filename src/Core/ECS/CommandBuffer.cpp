@@ -0,0 +1,46 @@
+#include "CommandBuffer.h"
+
+namespace UniversalEngine {
+    
+    void* CommandArena::Allocate(std::size_t size, std::size_t alignment) {
+        if (size > BLOCK_SIZE || alignment > alignof(Block)) {
+            throw std::runtime_error("Component is too large for the command arena");
+        }
+        
+        while (true) {
+            if (m_Block == m_Blocks.size()) {
+                m_Blocks.push_back(std::make_unique<Block>());
+                m_Offset = 0;
+            }
+            
+            std::size_t offset = (m_Offset + alignment - 1) & ~(alignment - 1);
+            if (offset + size <= BLOCK_SIZE) {
+                m_Offset = offset + size;
+                return m_Blocks[m_Block]->bytes + offset;
+            }
+            
+            ++m_Block;
+            m_Offset = 0;
+        }
+    }
+    
+    void CommandArena::Reset() {
+        m_Block = 0;
+        m_Offset = 0;
+    }
+    
+    void CommandBuffer::Clear() {
+        for (auto& queue : m_Queues) {
+            for (const ComponentCommand& command : queue->commands) {
+                if (command.payload) {
+                    queue->typeInfo.destroy(command.payload);
+                }
+            }
+            queue->commands.clear();
+            queue->addCount = 0;
+            queue->arena.Reset();
+        }
+        m_CommandCount = 0;
+    }
+    
+}
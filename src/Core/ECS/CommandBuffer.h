@@ -0,0 +1,144 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <memory>
+#include <vector>
+#include <array>
+#include <new>
+#include <stdexcept>
+#include "Entity.h"
+#include "Component.h"
+#include "Signature.h"
+#include "Span.h"
+#include "../Jobs/JobOrder.h"
+
+namespace UniversalEngine {
+    
+    // bump allocator over fixed blocks; Reset() rewinds without freeing so a steady
+    // stream of commands stops allocating once the blocks are warm
+    class CommandArena {
+    public:
+        static constexpr std::size_t BLOCK_SIZE = 64 * 1024;
+        
+        void* Allocate(std::size_t size, std::size_t alignment);
+        void Reset();
+        
+    private:
+        struct alignas(64) Block {
+            std::byte bytes[BLOCK_SIZE];
+        };
+        
+        std::vector<std::unique_ptr<Block>> m_Blocks;
+        std::size_t m_Block = 0;
+        std::size_t m_Offset = 0;
+    };
+    
+    enum class CommandType : std::uint8_t {
+        AddComponent,
+        RemoveComponent
+    };
+    
+    struct ComponentCommand {
+        Entity entity;
+        CommandType type;
+        void* payload;  // component living in the queue's arena, null for removals
+        SubmissionOrder order;
+    };
+    
+    // all deferred commands for one component type queued by one thread, in the order that
+    // thread queued them (not necessarily SubmissionOrder: a worker runs jobs in any order)
+    struct ComponentCommandQueue {
+        ComponentTypeInfo typeInfo;
+        std::vector<ComponentCommand> commands;
+        std::size_t addCount = 0;
+        CommandArena arena;
+    };
+    
+    class CommandBuffer {
+    public:
+        CommandBuffer() { m_QueueLookup.fill(NO_QUEUE); }
+        ~CommandBuffer() { Clear(); }
+        
+        CommandBuffer(const CommandBuffer&) = delete;
+        CommandBuffer& operator=(const CommandBuffer&) = delete;
+        
+        CommandBuffer(CommandBuffer&&) = default;
+        CommandBuffer& operator=(CommandBuffer&&) = default;
+        
+        template<typename T>
+        void AddComponent(Entity entity, T&& component, const SubmissionOrder& order) {
+            using Type = std::decay_t<T>;
+            ComponentCommandQueue& queue = GetQueue<Type>();
+            
+            void* payload = queue.arena.Allocate(sizeof(Type), alignof(Type));
+            new (payload) Type(std::forward<T>(component));
+            
+            queue.commands.push_back({ entity, CommandType::AddComponent, payload, order });
+            ++queue.addCount;
+            ++m_CommandCount;
+        }
+        
+        // firstOrder starts a run of entities.size() consecutive sequences
+        template<typename T>
+        void AddComponents(Span<const Entity> entities, const T& component, SubmissionOrder firstOrder) {
+            ComponentCommandQueue& queue = GetQueue<T>();
+            queue.commands.reserve(queue.commands.size() + entities.size());
+            
+            for (Entity entity : entities) {
+                void* payload = queue.arena.Allocate(sizeof(T), alignof(T));
+                new (payload) T(component);
+                queue.commands.push_back({ entity, CommandType::AddComponent, payload, firstOrder });
+                ++firstOrder.sequence;
+            }
+            
+            queue.addCount += entities.size();
+            m_CommandCount += entities.size();
+        }
+        
+        template<typename T>
+        void RemoveComponent(Entity entity, const SubmissionOrder& order) {
+            GetQueue<T>().commands.push_back({ entity, CommandType::RemoveComponent, nullptr, order });
+            ++m_CommandCount;
+        }
+        
+        // visits the per-type queues in the order their types were first used
+        template<typename Func>
+        void ForEachQueue(Func&& fn) {
+            for (auto& queue : m_Queues) {
+                if (!queue->commands.empty()) {
+                    fn(*queue);
+                }
+            }
+        }
+        
+        // destroys the (moved-from) payloads and rewinds the arenas, keeping their memory
+        void Clear();
+        
+        size_t GetCommandCount() const { return m_CommandCount; }
+        bool IsEmpty() const { return m_CommandCount == 0; }
+        
+    private:
+        static constexpr std::uint16_t NO_QUEUE = 0xFFFF;
+        
+        template<typename T>
+        ComponentCommandQueue& GetQueue() {
+            ComponentTypeID typeID = ComponentTypeRegistry::GetTypeID<T>();
+            if (typeID >= MAX_COMPONENTS) {
+                throw std::runtime_error("Too many component types, raise UE_MAX_COMPONENTS");
+            }
+            
+            if (m_QueueLookup[typeID] == NO_QUEUE) {
+                m_QueueLookup[typeID] = static_cast<std::uint16_t>(m_Queues.size());
+                m_Queues.push_back(std::make_unique<ComponentCommandQueue>());
+                m_Queues.back()->typeInfo = ComponentTypeInfo::Of<T>();
+            }
+            
+            return *m_Queues[m_QueueLookup[typeID]];
+        }
+        
+        std::vector<std::unique_ptr<ComponentCommandQueue>> m_Queues;
+        std::array<std::uint16_t, MAX_COMPONENTS> m_QueueLookup;
+        size_t m_CommandCount = 0;
+    };
+    
+}
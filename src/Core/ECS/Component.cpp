@@ -2,6 +2,6 @@
 
 namespace UniversalEngine {
     
-    ComponentTypeID ComponentTypeRegistry::s_NextTypeID = 1;
+    std::atomic<ComponentTypeID> ComponentTypeRegistry::s_NextTypeID{ 1 };
     
 }
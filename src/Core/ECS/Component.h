@@ -1,138 +1,514 @@
 #pragma once
 #include <cstdint>
+#include <cstring>
 #include <typeinfo>
-#include <unordered_map>
+#include <type_traits>
+#include <new>
 #include <memory>
 #include <vector>
 #include <array>
 #include <stdexcept>
+#include <utility>
+#include <atomic>
+#include <algorithm>
+#include <numeric>
+#include <functional>
+#include <string_view>
 #include "Entity.h"
+#include "PagedStorage.h"
 
 namespace UniversalEngine {
     
     using ComponentTypeID = std::uint32_t;
     
+    // World change counter; each stored component remembers the tick it was last written at
+    using Tick = std::uint32_t;
+    
+    // wrap-safe "tick is later than since"
+    inline bool IsNewerTick(Tick tick, Tick since) {
+        return static_cast<std::int32_t>(tick - since) > 0;
+    }
+    
     class Component {
     public:
         Component() = default;
         virtual ~Component() = default;
         
-        Component(const Component&) = delete;
-        Component& operator=(const Component&) = delete;
+        Component(const Component&) = default;
+        Component& operator=(const Component&) = default;
         
         Component(Component&&) = default;
         Component& operator=(Component&&) = default;
     };
     
+    // Opt-in for plain structs that skip the virtual Component base, e.g.
+    //     template<> struct IsPODComponent<Transform2D> : std::true_type {};
+    // Such types must be trivially copyable; storage then moves them with memcpy.
+    template<typename T>
+    struct IsPODComponent : std::false_type {};
+    
+    template<typename T>
+    inline constexpr bool IsComponent_v = std::is_base_of_v<Component, T> ||
+                                          (IsPODComponent<T>::value && std::is_trivially_copyable_v<T>);
+    
     class ComponentTypeRegistry {
     public:
         template<typename T>
         static ComponentTypeID GetTypeID() {
-            static_assert(std::is_base_of_v<Component, T>, "T must inherit from Component");
+            static_assert(IsComponent_v<T>, "T must inherit from Component or be an opted-in POD component");
             
             static ComponentTypeID typeID = s_NextTypeID++;
             return typeID;
         }
         
-        static ComponentTypeID GetNextTypeID() { return s_NextTypeID; }
+        static ComponentTypeID GetNextTypeID() { return s_NextTypeID.load(); }
         
     private:
-        static ComponentTypeID s_NextTypeID;
+        static std::atomic<ComponentTypeID> s_NextTypeID;
+    };
+    
+    // Specialize to move a component type into paged storage: its ComponentArray keeps the
+    // components in fixed-size pooled pages, so a T& stays valid while other entities gain T.
+    // Removing T (or a group reordering T) still moves the last element into the hole.
+    template<typename T>
+    struct ComponentStorageTraits {
+        static constexpr bool STABLE_POINTERS = false;
+        static constexpr std::size_t PAGE_SIZE = 1024;
+    };
+    
+    namespace detail {
+        
+        // T's qualified name as spelled in this function's signature, minus the "class " or
+        // "struct " MSVC puts in front, so GCC, Clang and MSVC agree on non-template types
+        template<typename T>
+        constexpr std::string_view DeriveTypeName() {
+#if defined(_MSC_VER) && !defined(__clang__)
+            std::string_view signature = __FUNCSIG__;
+            std::size_t begin = signature.find("DeriveTypeName<") + sizeof("DeriveTypeName<") - 1;
+            std::size_t end = signature.rfind(">(void)");
+#else
+            std::string_view signature = __PRETTY_FUNCTION__;
+            std::size_t begin = signature.find("T = ") + sizeof("T = ") - 1;
+            std::size_t end = signature.find(';', begin);
+            if (end == std::string_view::npos) {
+                end = signature.rfind(']');
+            }
+#endif
+            std::string_view name = signature.substr(begin, end - begin);
+            for (std::string_view keyword : { std::string_view("class "), std::string_view("struct "), std::string_view("enum ") }) {
+                if (name.substr(0, keyword.size()) == keyword) {
+                    name.remove_prefix(keyword.size());
+                }
+            }
+            return name;
+        }
+        
+    }
+    
+    // Name snapshots key a component column by. Derived from the type at compile time;
+    // specialize it to pin a name that survives renaming or moving the type, e.g.
+    //     template<> struct ComponentName<Transform2D> { static constexpr std::string_view value = "Transform2D"; };
+    template<typename T>
+    struct ComponentName {
+        static constexpr std::string_view value = detail::DeriveTypeName<T>();
+    };
+    
+    class IComponentArray;
+    
+    template<typename T>
+    class ComponentArray;
+    
+    // type-erased operations for moving components through untyped storage
+    struct ComponentTypeInfo {
+        ComponentTypeID id = 0;
+        std::size_t size = 0;
+        std::size_t alignment = 0;
+        void (*moveConstruct)(void* destination, void* source) = nullptr;
+        void (*destroy)(void* component) = nullptr;
+        void (*copyConstruct)(void* destination, const void* source) = nullptr;  // null if T is move-only
+        std::unique_ptr<IComponentArray> (*createArray)() = nullptr;
+        bool triviallyCopyable = false;
+        
+        // FNV-1a of ComponentName<T>; unlike id it does not depend on registration order or
+        // on the compiler's RTTI spelling, so snapshots key their columns by it
+        std::uint64_t nameHash = 0;
+        
+        template<typename T>
+        static ComponentTypeInfo Of() {
+            ComponentTypeInfo info;
+            info.id = ComponentTypeRegistry::GetTypeID<T>();
+            info.nameHash = HashName(ComponentName<T>::value);
+            info.size = sizeof(T);
+            info.alignment = alignof(T);
+            if constexpr (std::is_trivially_copyable_v<T>) {
+                info.moveConstruct = [](void* destination, void* source) {
+                    std::memcpy(destination, source, sizeof(T));
+                };
+            } else {
+                info.moveConstruct = [](void* destination, void* source) {
+                    new (destination) T(std::move(*static_cast<T*>(source)));
+                };
+            }
+            if constexpr (std::is_trivially_destructible_v<T>) {
+                info.destroy = [](void*) {};
+            } else {
+                info.destroy = [](void* component) {
+                    static_cast<T*>(component)->~T();
+                };
+            }
+            if constexpr (std::is_copy_constructible_v<T>) {
+                info.copyConstruct = [](void* destination, const void* source) {
+                    new (destination) T(*static_cast<const T*>(source));
+                };
+            }
+            info.createArray = []() -> std::unique_ptr<IComponentArray> {
+                return std::make_unique<ComponentArray<T>>();
+            };
+            info.triviallyCopyable = std::is_trivially_copyable_v<T>;
+            return info;
+        }
+        
+        static std::uint64_t HashName(std::string_view name) {
+            std::uint64_t hash = 14695981039346656037ull;
+            for (char c : name) {
+                hash = (hash ^ static_cast<unsigned char>(c)) * 1099511628211ull;
+            }
+            return hash;
+        }
     };
     
     class IComponentArray {
     public:
+        static constexpr std::uint32_t INVALID_INDEX = ~std::uint32_t(0);
+        
         virtual ~IComponentArray() = default;
         virtual void EntityDestroyed(EntityID entity) = 0;
         virtual size_t Size() const = 0;
+        
+        // type-erased entry points used when applying deferred commands
+        virtual void InsertMoved(EntityID entity, void* component) = 0;
+        virtual void Remove(EntityID entity) = 0;
+        virtual void Reserve(size_t capacity) = 0;
+        
+        // appends a copy of prototype for each of count entities that have no component yet
+        virtual void InsertCopies(const EntityID* entities, size_t count, const void* prototype) = 0;
+        
+        // dense-order access used by groups to keep several arrays in lockstep
+        virtual std::uint32_t IndexOf(EntityID entity) const = 0;
+        virtual EntityID EntityAt(size_t index) const = 0;
+        virtual const EntityID* EntityData() const = 0;
+        virtual void SwapEntries(size_t a, size_t b) = 0;
+        
+        // the World tick that inserts and mutable accesses are stamped with
+        virtual void SetTickSource(const Tick* tick) = 0;
+        
+        virtual const ComponentTypeInfo& GetTypeInfo() const = 0;
+        
+        // Snapshot support. Clear() drops every element; Assign() replaces the contents with
+        // default-constructed components for entities[0, count), stamped at the current tick.
+        // ForEachRawRange() hands out the dense components as contiguous byte ranges, one per
+        // page in paged storage; only trivially copyable types may be read or written that way.
+        virtual void Clear() = 0;
+        virtual void Assign(const EntityID* entities, size_t count) = 0;
+        virtual void ForEachRawRange(const std::function<void(void* bytes, size_t size)>& fn) = 0;
     };
     
+    // sparse set: paged sparse EntityID -> dense index, dense index -> EntityID.
+    // A parallel tick column records when each element was inserted or last taken through
+    // GetMut()/MarkChanged(); plain GetData() and begin()/end() do not stamp it.
     template<typename T>
     class ComponentArray : public IComponentArray {
-        static_assert(std::is_base_of_v<Component, T>, "T must inherit from Component");
+        static_assert(IsComponent_v<T>, "T must inherit from Component or be an opted-in POD component");
         
     public:
+        static constexpr std::size_t SPARSE_PAGE_SIZE = 4096;
+        static constexpr bool STABLE_POINTERS = ComponentStorageTraits<T>::STABLE_POINTERS;
+        
         void InsertData(EntityID entity, T component) {
-            if (m_EntityToIndexMap.find(entity) != m_EntityToIndexMap.end()) {
-                size_t index = m_EntityToIndexMap[entity];
-                m_ComponentArray[index] = std::move(component);
+            std::uint32_t& slot = AssureSparseSlot(entity);
+            if (slot != INVALID_INDEX) {
+                m_ComponentArray[slot] = std::move(component);
+                m_Ticks[slot] = CurrentTick();
                 return;
             }
             
-            size_t newIndex = m_Size;
-            m_EntityToIndexMap[entity] = newIndex;
-            m_IndexToEntityMap[newIndex] = entity;
-            
-            if (newIndex >= m_ComponentArray.size()) {
-                m_ComponentArray.resize(newIndex + 1);
-            }
-            
-            m_ComponentArray[newIndex] = std::move(component);
-            ++m_Size;
+            slot = static_cast<std::uint32_t>(m_Dense.size());
+            m_Dense.push_back(entity);
+            m_ComponentArray.push_back(std::move(component));
+            m_Ticks.push_back(CurrentTick());
         }
         
         void RemoveData(EntityID entity) {
-            if (m_EntityToIndexMap.find(entity) == m_EntityToIndexMap.end()) {
+            std::uint32_t index = GetIndex(entity);
+            if (index == INVALID_INDEX) {
                 return;
             }
             
-            size_t indexOfRemovedEntity = m_EntityToIndexMap[entity];
-            size_t indexOfLastElement = m_Size - 1;
-            m_ComponentArray[indexOfRemovedEntity] = std::move(m_ComponentArray[indexOfLastElement]);
-            
-            EntityID entityOfLastElement = m_IndexToEntityMap[indexOfLastElement];
-            m_EntityToIndexMap[entityOfLastElement] = indexOfRemovedEntity;
-            m_IndexToEntityMap[indexOfRemovedEntity] = entityOfLastElement;
-            
-            m_EntityToIndexMap.erase(entity);
-            m_IndexToEntityMap.erase(indexOfLastElement);
+            // removing the last element needs no move, and memcpy must not overlap itself
+            std::uint32_t last = static_cast<std::uint32_t>(m_Dense.size() - 1);
+            if (index != last) {
+                EntityID entityOfLastElement = m_Dense[last];
+                if constexpr (std::is_trivially_copyable_v<T>) {
+                    std::memcpy(static_cast<void*>(&m_ComponentArray[index]), &m_ComponentArray[last], sizeof(T));
+                } else {
+                    m_ComponentArray[index] = std::move(m_ComponentArray[last]);
+                }
+                m_Dense[index] = entityOfLastElement;
+                m_Ticks[index] = m_Ticks[last];
+                SparseSlot(entityOfLastElement) = index;
+            }
+            SparseSlot(entity) = INVALID_INDEX;
             
-            --m_Size;
+            m_ComponentArray.pop_back();
+            m_Dense.pop_back();
+            m_Ticks.pop_back();
         }
         
         T& GetData(EntityID entity) {
-            if (m_EntityToIndexMap.find(entity) == m_EntityToIndexMap.end()) {
+            std::uint32_t index = GetIndex(entity);
+            if (index == INVALID_INDEX) {
                 throw std::runtime_error("Entity does not have this component");
             }
             
-            return m_ComponentArray[m_EntityToIndexMap[entity]];
+            return m_ComponentArray[index];
         }
         
         const T& GetData(EntityID entity) const {
-            if (m_EntityToIndexMap.find(entity) == m_EntityToIndexMap.end()) {
+            std::uint32_t index = GetIndex(entity);
+            if (index == INVALID_INDEX) {
                 throw std::runtime_error("Entity does not have this component");
             }
             
-            return m_ComponentArray[m_EntityToIndexMap.at(entity)];
+            return m_ComponentArray[index];
+        }
+        
+        // GetData() that also stamps the element as changed at the current tick
+        T& GetMut(EntityID entity) {
+            std::uint32_t index = GetIndex(entity);
+            if (index == INVALID_INDEX) {
+                throw std::runtime_error("Entity does not have this component");
+            }
+            
+            m_Ticks[index] = CurrentTick();
+            return m_ComponentArray[index];
+        }
+        
+        void MarkChangedAt(std::size_t index) { m_Ticks[index] = CurrentTick(); }
+        
+        void MarkChangedRange(std::size_t begin, std::size_t end) {
+            std::fill(m_Ticks.begin() + begin, m_Ticks.begin() + end, CurrentTick());
         }
         
+        Tick GetChangeTickAt(std::size_t index) const { return m_Ticks[index]; }
+        
         bool HasData(EntityID entity) const {
-            return m_EntityToIndexMap.find(entity) != m_EntityToIndexMap.end();
+            return GetIndex(entity) != INVALID_INDEX;
         }
         
-        void EntityDestroyed(EntityID entity) override {
-            if (m_EntityToIndexMap.find(entity) != m_EntityToIndexMap.end()) {
-                RemoveData(entity);
+        // dense index of the entity's component, INVALID_INDEX if it has none
+        std::uint32_t GetIndex(EntityID entity) const {
+            std::size_t page = entity / SPARSE_PAGE_SIZE;
+            if (page >= m_Sparse.size() || !m_Sparse[page]) {
+                return INVALID_INDEX;
             }
+            return (*m_Sparse[page])[entity % SPARSE_PAGE_SIZE];
+        }
+        
+        EntityID GetEntity(std::size_t index) const { return m_Dense[index]; }
+        T& GetDataAt(std::size_t index) { return m_ComponentArray[index]; }
+        const T& GetDataAt(std::size_t index) const { return m_ComponentArray[index]; }
+        
+        const std::vector<EntityID>& GetEntities() const { return m_Dense; }
+        
+        void EntityDestroyed(EntityID entity) override {
+            RemoveData(entity);
         }
         
         size_t Size() const override {
-            return m_Size;
+            return m_Dense.size();
+        }
+        
+        void InsertMoved(EntityID entity, void* component) override {
+            InsertData(entity, std::move(*static_cast<T*>(component)));
+        }
+        
+        void Remove(EntityID entity) override {
+            RemoveData(entity);
+        }
+        
+        void Reserve(size_t capacity) override {
+            m_ComponentArray.reserve(capacity);
+            m_Dense.reserve(capacity);
+            m_Ticks.reserve(capacity);
         }
         
+        void InsertCopies(const EntityID* entities, size_t count, const void* prototype) override {
+            if constexpr (std::is_copy_constructible_v<T>) {
+                std::uint32_t first = static_cast<std::uint32_t>(m_Dense.size());
+                m_Dense.insert(m_Dense.end(), entities, entities + count);
+                m_Ticks.insert(m_Ticks.end(), count, CurrentTick());
+                const T& value = *static_cast<const T*>(prototype);
+                if constexpr (STABLE_POINTERS) {
+                    m_ComponentArray.reserve(m_ComponentArray.size() + count);
+                    for (size_t i = 0; i < count; ++i) {
+                        m_ComponentArray.push_back(value);
+                    }
+                } else {
+                    m_ComponentArray.insert(m_ComponentArray.end(), count, value);
+                }
+                
+                for (size_t i = 0; i < count; ++i) {
+                    AssureSparseSlot(entities[i]) = first + static_cast<std::uint32_t>(i);
+                }
+            } else {
+                throw std::runtime_error("Component type is not copyable");
+            }
+        }
+        
+        std::uint32_t IndexOf(EntityID entity) const override {
+            return GetIndex(entity);
+        }
+        
+        EntityID EntityAt(size_t index) const override {
+            return m_Dense[index];
+        }
+        
+        const EntityID* EntityData() const override {
+            return m_Dense.data();
+        }
+        
+        void SwapEntries(size_t a, size_t b) override {
+            if (a == b) {
+                return;
+            }
+            
+            if constexpr (std::is_trivially_copyable_v<T>) {
+                alignas(T) unsigned char buffer[sizeof(T)];
+                std::memcpy(buffer, &m_ComponentArray[a], sizeof(T));
+                std::memcpy(static_cast<void*>(&m_ComponentArray[a]), &m_ComponentArray[b], sizeof(T));
+                std::memcpy(static_cast<void*>(&m_ComponentArray[b]), buffer, sizeof(T));
+            } else {
+                std::swap(m_ComponentArray[a], m_ComponentArray[b]);
+            }
+            std::swap(m_Dense[a], m_Dense[b]);
+            std::swap(m_Ticks[a], m_Ticks[b]);
+            SparseSlot(m_Dense[a]) = static_cast<std::uint32_t>(a);
+            SparseSlot(m_Dense[b]) = static_cast<std::uint32_t>(b);
+        }
+        
+        // reorders the dense arrays with cmp(const T&, const T&); ticks and lookups follow
+        template<typename Compare>
+        void Sort(Compare cmp) {
+            std::vector<std::uint32_t> order(m_Dense.size());
+            std::iota(order.begin(), order.end(), 0u);
+            std::sort(order.begin(), order.end(), [this, &cmp](std::uint32_t a, std::uint32_t b) {
+                return cmp(static_cast<const T&>(m_ComponentArray[a]), static_cast<const T&>(m_ComponentArray[b]));
+            });
+            
+            // order[k] is the old index that belongs at k; walk each cycle of the permutation
+            for (std::size_t i = 0; i < order.size(); ++i) {
+                std::size_t current = i;
+                while (order[current] != i) {
+                    std::size_t next = order[current];
+                    SwapEntries(current, next);
+                    order[current] = static_cast<std::uint32_t>(current);
+                    current = next;
+                }
+                order[current] = static_cast<std::uint32_t>(current);
+            }
+        }
+        
+        void SetTickSource(const Tick* tick) override {
+            m_TickSource = tick;
+        }
+        
+        const ComponentTypeInfo& GetTypeInfo() const override {
+            static const ComponentTypeInfo typeInfo = ComponentTypeInfo::Of<T>();
+            return typeInfo;
+        }
+        
+        void Clear() override {
+            for (EntityID entity : m_Dense) {
+                SparseSlot(entity) = INVALID_INDEX;
+            }
+            m_ComponentArray.clear();
+            m_Dense.clear();
+            m_Ticks.clear();
+        }
+        
+        void Assign(const EntityID* entities, size_t count) override {
+            if constexpr (std::is_default_constructible_v<T>) {
+                Clear();
+                m_Dense.assign(entities, entities + count);
+                m_Ticks.assign(count, CurrentTick());
+                if constexpr (STABLE_POINTERS) {
+                    m_ComponentArray.reserve(count);
+                    for (size_t i = 0; i < count; ++i) {
+                        m_ComponentArray.emplace_back();
+                    }
+                } else {
+                    m_ComponentArray.resize(count);
+                }
+                
+                for (size_t i = 0; i < count; ++i) {
+                    AssureSparseSlot(entities[i]) = static_cast<std::uint32_t>(i);
+                }
+            } else {
+                throw std::runtime_error("Component type is not default constructible");
+            }
+        }
+        
+        void ForEachRawRange(const std::function<void(void* bytes, size_t size)>& fn) override {
+            if constexpr (STABLE_POINTERS) {
+                constexpr std::size_t PAGE_SIZE = ComponentStorageTraits<T>::PAGE_SIZE;
+                for (std::size_t begin = 0; begin < m_ComponentArray.size(); begin += PAGE_SIZE) {
+                    std::size_t count = std::min(PAGE_SIZE, m_ComponentArray.size() - begin);
+                    fn(&m_ComponentArray[begin], count * sizeof(T));
+                }
+            } else if (!m_ComponentArray.empty()) {
+                fn(m_ComponentArray.data(), m_ComponentArray.size() * sizeof(T));
+            }
+        }
+        
+        // contiguous storage only; paged arrays are walked by index
         T* begin() { return m_ComponentArray.data(); }
-        T* end() { return m_ComponentArray.data() + m_Size; }
+        T* end() { return m_ComponentArray.data() + m_ComponentArray.size(); }
         const T* begin() const { return m_ComponentArray.data(); }
-        const T* end() const { return m_ComponentArray.data() + m_Size; }
+        const T* end() const { return m_ComponentArray.data() + m_ComponentArray.size(); }
         
     private:
-        std::vector<T> m_ComponentArray;
+        using SparsePage = std::array<std::uint32_t, SPARSE_PAGE_SIZE>;
+        
+        Tick CurrentTick() const { return m_TickSource ? *m_TickSource : 0; }
+        
+        std::uint32_t& SparseSlot(EntityID entity) {
+            return (*m_Sparse[entity / SPARSE_PAGE_SIZE])[entity % SPARSE_PAGE_SIZE];
+        }
+        
+        std::uint32_t& AssureSparseSlot(EntityID entity) {
+            std::size_t page = entity / SPARSE_PAGE_SIZE;
+            if (page >= m_Sparse.size()) {
+                m_Sparse.resize(page + 1);
+            }
+            if (!m_Sparse[page]) {
+                m_Sparse[page] = std::make_unique<SparsePage>();
+                m_Sparse[page]->fill(INVALID_INDEX);
+            }
+            return (*m_Sparse[page])[entity % SPARSE_PAGE_SIZE];
+        }
+        
+        using Storage = std::conditional_t<STABLE_POINTERS,
+                                           PagedVector<T, ComponentStorageTraits<T>::PAGE_SIZE>,
+                                           std::vector<T>>;
+        
+        Storage m_ComponentArray;
         
-        std::unordered_map<EntityID, size_t> m_EntityToIndexMap;
+        std::vector<EntityID> m_Dense;
         
-        std::unordered_map<size_t, EntityID> m_IndexToEntityMap;
+        std::vector<std::unique_ptr<SparsePage>> m_Sparse;
         
-        size_t m_Size = 0;
+        std::vector<Tick> m_Ticks;
+        const Tick* m_TickSource = nullptr;
     };
     
     class Entity;
@@ -4,25 +4,32 @@
 namespace UniversalEngine {
     
     using EntityID = std::uint32_t;
+    using EntityGeneration = std::uint32_t;
     
     constexpr EntityID INVALID_ENTITY = 0;
     
+    // a slot index plus the generation it was handed out with; stale handles to a recycled
+    // slot carry an older generation and fail World::IsEntityValid
     class Entity {
     public:
-        Entity() : m_ID(INVALID_ENTITY) {}
-        explicit Entity(EntityID id) : m_ID(id) {}
+        Entity() : m_ID(INVALID_ENTITY), m_Generation(0) {}
+        explicit Entity(EntityID id, EntityGeneration generation = 0) : m_ID(id), m_Generation(generation) {}
         
         EntityID GetID() const { return m_ID; }
+        EntityGeneration GetGeneration() const { return m_Generation; }
         bool IsValid() const { return m_ID != INVALID_ENTITY; }
         
-        bool operator==(const Entity& other) const { return m_ID == other.m_ID; }
-        bool operator!=(const Entity& other) const { return m_ID != other.m_ID; }
-        bool operator<(const Entity& other) const { return m_ID < other.m_ID; }
+        bool operator==(const Entity& other) const { return m_ID == other.m_ID && m_Generation == other.m_Generation; }
+        bool operator!=(const Entity& other) const { return !(*this == other); }
+        bool operator<(const Entity& other) const {
+            return m_ID != other.m_ID ? m_ID < other.m_ID : m_Generation < other.m_Generation;
+        }
         
         operator EntityID() const { return m_ID; }
         
     private:
         EntityID m_ID;
+        EntityGeneration m_Generation;
     };
     
     class World;
@@ -0,0 +1,78 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include <algorithm>
+#include "Entity.h"
+#include "Span.h"
+
+namespace UniversalEngine {
+    
+    // dense Entity list plus an EntityID -> index lookup; O(1) insert, erase and contains.
+    // Erase swaps the last entity into the hole, so order is only kept until the next erase.
+    class EntitySet {
+    public:
+        static constexpr std::uint32_t INVALID_INDEX = ~std::uint32_t(0);
+        
+        bool Insert(Entity entity) {
+            EntityID id = entity.GetID();
+            if (id >= m_Sparse.size()) {
+                m_Sparse.resize(static_cast<size_t>(id) + 1, INVALID_INDEX);
+            }
+            if (m_Sparse[id] != INVALID_INDEX) {
+                return false;
+            }
+            
+            m_Sparse[id] = static_cast<std::uint32_t>(m_Dense.size());
+            m_Dense.push_back(entity);
+            return true;
+        }
+        
+        bool Erase(Entity entity) {
+            if (!Contains(entity)) {
+                return false;
+            }
+            
+            std::uint32_t index = m_Sparse[entity.GetID()];
+            Entity last = m_Dense.back();
+            m_Dense[index] = last;
+            m_Sparse[last.GetID()] = index;
+            m_Dense.pop_back();
+            m_Sparse[entity.GetID()] = INVALID_INDEX;
+            return true;
+        }
+        
+        bool Contains(Entity entity) const {
+            EntityID id = entity.GetID();
+            return id < m_Sparse.size() && m_Sparse[id] != INVALID_INDEX && m_Dense[m_Sparse[id]] == entity;
+        }
+        
+        void Reserve(size_t capacity) { m_Dense.reserve(capacity); }
+        
+        size_t Size() const { return m_Dense.size(); }
+        bool Empty() const { return m_Dense.empty(); }
+        
+        void Clear() {
+            m_Dense.clear();
+            m_Sparse.clear();
+        }
+        
+        // orders the dense list with cmp(Entity, Entity) and rebuilds the lookup
+        template<typename Compare>
+        void Sort(Compare cmp) {
+            std::sort(m_Dense.begin(), m_Dense.end(), cmp);
+            for (size_t i = 0; i < m_Dense.size(); ++i) {
+                m_Sparse[m_Dense[i].GetID()] = static_cast<std::uint32_t>(i);
+            }
+        }
+        
+        Span<const Entity> GetEntities() const { return Span<const Entity>(m_Dense); }
+        
+        const Entity* begin() const { return m_Dense.data(); }
+        const Entity* end() const { return m_Dense.data() + m_Dense.size(); }
+    
+    private:
+        std::vector<Entity> m_Dense;
+        std::vector<std::uint32_t> m_Sparse;
+    };
+
+}
@@ -0,0 +1,102 @@
+#pragma once
+#include <cstddef>
+#include <tuple>
+#include <vector>
+#include <type_traits>
+#include <utility>
+#include "Entity.h"
+#include "Component.h"
+#include "Signature.h"
+#include "../Jobs/JobSystem.h"
+
+namespace UniversalEngine {
+    
+    // Bookkeeping for one owning group. The first `size` entries of every owned array
+    // belong to the same entities in the same order; World keeps that invariant while
+    // it applies component adds/removes and entity destruction.
+    struct GroupData {
+        Signature owned;
+        std::vector<IComponentArray*> arrays;
+        size_t size = 0;
+        
+        bool Contains(EntityID entity) const {
+            std::uint32_t index = arrays[0]->IndexOf(entity);
+            return index != IComponentArray::INVALID_INDEX && index < size;
+        }
+        
+        bool Matches(EntityID entity) const {
+            for (IComponentArray* componentArray : arrays) {
+                if (componentArray->IndexOf(entity) == IComponentArray::INVALID_INDEX) {
+                    return false;
+                }
+            }
+            return true;
+        }
+        
+        void Enter(EntityID entity) {
+            for (IComponentArray* componentArray : arrays) {
+                componentArray->SwapEntries(componentArray->IndexOf(entity), size);
+            }
+            ++size;
+        }
+        
+        void Leave(EntityID entity) {
+            --size;
+            for (IComponentArray* componentArray : arrays) {
+                componentArray->SwapEntries(componentArray->IndexOf(entity), size);
+            }
+        }
+    };
+    
+    // typed handle over a GroupData; iteration walks the packed prefix of every owned array in lockstep.
+    // As with View<const T>, a const type (Group<const T>) is still owned and packed, but is
+    // handed out as a const reference and never stamped as changed.
+    template<typename... Ts>
+    class OwningGroup {
+    public:
+        OwningGroup(GroupData* data, const std::vector<EntityGeneration>* generations, ComponentArray<std::remove_const_t<Ts>>*... arrays)
+            : m_Data(data), m_Generations(generations), m_Arrays(arrays...) {}
+        
+        // calls fn(Entity, Ts&...) for every entity in the group; every visited element of a
+        // non-const type is stamped as changed
+        template<typename Func>
+        void Each(Func&& fn) const {
+            EachInRange(0, m_Data->size, fn);
+        }
+        
+        template<typename Func>
+        void EachInRange(size_t begin, size_t end, Func&& fn) const {
+            (MarkChanged<Ts>(begin, end), ...);
+            
+            const auto& entities = std::get<0>(m_Arrays)->GetEntities();
+            for (size_t i = begin; i < end; ++i) {
+                EntityID entity = entities[i];
+                fn(Entity(entity, (*m_Generations)[entity]), static_cast<Ts&>(std::get<ComponentArray<std::remove_const_t<Ts>>*>(m_Arrays)->GetDataAt(i))...);
+            }
+        }
+        
+        // Each() split across jobSystem in ranges that are whole cache lines of every owned array
+        template<typename Func>
+        void ParallelEach(JobSystem& jobSystem, Func&& fn, size_t grainSize = 1024) const {
+            jobSystem.ParallelFor(m_Data->size, JobSystem::CacheAlignedGrain<Ts...>(grainSize),
+                [this, &fn](size_t begin, size_t end) {
+                    EachInRange(begin, end, fn);
+                });
+        }
+        
+        size_t Size() const { return m_Data->size; }
+    
+    private:
+        template<typename T>
+        void MarkChanged(size_t begin, size_t end) const {
+            if constexpr (!std::is_const_v<T>) {
+                std::get<ComponentArray<T>*>(m_Arrays)->MarkChangedRange(begin, end);
+            }
+        }
+        
+        GroupData* m_Data;
+        const std::vector<EntityGeneration>* m_Generations;
+        std::tuple<ComponentArray<std::remove_const_t<Ts>>*...> m_Arrays;
+    };
+
+}
@@ -2,14 +2,12 @@
 #include <cstdint>
 #include <queue>
 #include <vector>
-#include <set>
 #include "../Entity.h"
 #include "../Component.h"
+#include "../Signature.h"
 
 namespace UniversalEngine {
     
-    using Signature = std::set<ComponentTypeID>;
-    
     class EntityManager {
     public:
         EntityManager();
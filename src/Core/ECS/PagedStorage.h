@@ -0,0 +1,105 @@
+#pragma once
+#include <cstddef>
+#include <new>
+#include <mutex>
+#include <vector>
+#include <utility>
+
+namespace UniversalEngine {
+    
+    // Recycles fixed-size pages of PageSize Ts. Pages are never returned to the system; the
+    // pool is intentionally leaked so arrays destroyed during static teardown can still release.
+    template<typename T, std::size_t PageSize>
+    class PagePool {
+    public:
+        static PagePool& Get() {
+            static PagePool* pool = new PagePool();
+            return *pool;
+        }
+        
+        T* Allocate() {
+            {
+                std::lock_guard<std::mutex> lock(m_Mutex);
+                if (!m_FreePages.empty()) {
+                    T* page = m_FreePages.back();
+                    m_FreePages.pop_back();
+                    return page;
+                }
+            }
+            return static_cast<T*>(::operator new(sizeof(T) * PageSize, std::align_val_t(alignof(T))));
+        }
+        
+        void Release(T* page) {
+            std::lock_guard<std::mutex> lock(m_Mutex);
+            m_FreePages.push_back(page);
+        }
+    
+    private:
+        PagePool() = default;
+        
+        std::mutex m_Mutex;
+        std::vector<T*> m_FreePages;
+    };
+    
+    // Vector-like storage split into fixed-size pages. Growing allocates a new page and never
+    // moves existing elements, so references stay valid until that element is erased or moved.
+    template<typename T, std::size_t PageSize>
+    class PagedVector {
+        static_assert(PageSize > 0 && (PageSize & (PageSize - 1)) == 0, "PageSize must be a power of two");
+    
+    public:
+        PagedVector() = default;
+        ~PagedVector() {
+            clear();
+            for (T* page : m_Pages) {
+                PagePool<T, PageSize>::Get().Release(page);
+            }
+        }
+        
+        PagedVector(const PagedVector&) = delete;
+        PagedVector& operator=(const PagedVector&) = delete;
+        
+        T& operator[](std::size_t index) { return m_Pages[index / PageSize][index % PageSize]; }
+        const T& operator[](std::size_t index) const { return m_Pages[index / PageSize][index % PageSize]; }
+        
+        T& back() { return (*this)[m_Size - 1]; }
+        
+        std::size_t size() const { return m_Size; }
+        bool empty() const { return m_Size == 0; }
+        
+        template<typename... Args>
+        T& emplace_back(Args&&... args) {
+            reserve(m_Size + 1);
+            T* slot = &m_Pages[m_Size / PageSize][m_Size % PageSize];
+            new (slot) T(std::forward<Args>(args)...);
+            ++m_Size;
+            return *slot;
+        }
+        
+        void push_back(T&& value) { emplace_back(std::move(value)); }
+        void push_back(const T& value) { emplace_back(value); }
+        
+        void pop_back() {
+            --m_Size;
+            (*this)[m_Size].~T();
+        }
+        
+        void reserve(std::size_t capacity) {
+            while (m_Pages.size() * PageSize < capacity) {
+                m_Pages.push_back(PagePool<T, PageSize>::Get().Allocate());
+            }
+        }
+        
+        // destroys every element but keeps the pages
+        void clear() {
+            while (m_Size > 0) {
+                pop_back();
+            }
+        }
+    
+    private:
+        std::vector<T*> m_Pages;
+        std::size_t m_Size = 0;
+    };
+
+}
@@ -0,0 +1,110 @@
+#pragma once
+#include <cstddef>
+#include <new>
+#include <vector>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include "Component.h"
+#include "Signature.h"
+
+namespace UniversalEngine {
+    
+    // A component set with default values. World::Instantiate stamps it onto new entities
+    // one column at a time, without going through the command buffer.
+    class Prefab {
+    public:
+        Prefab() = default;
+        ~Prefab() { Clear(); }
+        
+        Prefab(const Prefab&) = delete;
+        Prefab& operator=(const Prefab&) = delete;
+        
+        Prefab(Prefab&& other) noexcept
+            : m_Signature(other.m_Signature), m_Components(std::move(other.m_Components)) {
+            other.m_Signature.reset();
+            other.m_Components.clear();
+        }
+        
+        Prefab& operator=(Prefab&& other) noexcept {
+            if (this != &other) {
+                Clear();
+                m_Signature = other.m_Signature;
+                m_Components = std::move(other.m_Components);
+                other.m_Signature.reset();
+                other.m_Components.clear();
+            }
+            return *this;
+        }
+        
+        // adds or replaces the prototype for T
+        template<typename T>
+        Prefab& Set(T component) {
+            static_assert(IsComponent_v<T>, "T must inherit from Component or be an opted-in POD component");
+            static_assert(std::is_copy_constructible_v<T>, "Prefab components must be copyable");
+            
+            ComponentTypeInfo typeInfo = ComponentTypeInfo::Of<T>();
+            if (typeInfo.id >= MAX_COMPONENTS) {
+                throw std::runtime_error("Too many component types, raise UE_MAX_COMPONENTS");
+            }
+            
+            if (m_Signature.test(typeInfo.id)) {
+                Get<T>() = std::move(component);
+                return *this;
+            }
+            
+            void* prototype = ::operator new(typeInfo.size, std::align_val_t(typeInfo.alignment));
+            new (prototype) T(std::move(component));
+            
+            m_Components.push_back({ typeInfo, prototype });
+            m_Signature.set(typeInfo.id);
+            return *this;
+        }
+        
+        template<typename T>
+        bool Has() const {
+            return m_Signature.test(ComponentTypeRegistry::GetTypeID<T>());
+        }
+        
+        template<typename T>
+        T& Get() {
+            ComponentTypeID typeID = ComponentTypeRegistry::GetTypeID<T>();
+            for (PrefabComponent& component : m_Components) {
+                if (component.typeInfo.id == typeID) {
+                    return *static_cast<T*>(component.prototype);
+                }
+            }
+            throw std::runtime_error("Prefab does not have this component");
+        }
+        
+        const Signature& GetSignature() const { return m_Signature; }
+        size_t GetComponentCount() const { return m_Components.size(); }
+        
+        // fn(const ComponentTypeInfo&, const void* prototype)
+        template<typename Func>
+        void ForEachComponent(Func&& fn) const {
+            for (const PrefabComponent& component : m_Components) {
+                fn(component.typeInfo, static_cast<const void*>(component.prototype));
+            }
+        }
+    
+    private:
+        struct PrefabComponent {
+            ComponentTypeInfo typeInfo;
+            void* prototype;
+        };
+        
+        void Clear() {
+            for (PrefabComponent& component : m_Components) {
+                component.typeInfo.destroy(component.prototype);
+                ::operator delete(component.prototype, std::align_val_t(component.typeInfo.alignment));
+            }
+            m_Components.clear();
+            m_Signature.reset();
+        }
+        
+        Signature m_Signature;
+        std::vector<PrefabComponent> m_Components;
+    };
+
+}
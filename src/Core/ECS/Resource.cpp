@@ -0,0 +1,7 @@
+#include "Resource.h"
+
+namespace UniversalEngine {
+    
+    std::atomic<ResourceTypeID> ResourceTypeRegistry::s_NextTypeID{ 0 };
+
+}
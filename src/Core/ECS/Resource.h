@@ -0,0 +1,26 @@
+#pragma once
+#include <cstdint>
+#include <atomic>
+
+namespace UniversalEngine {
+    
+    using ResourceTypeID = std::uint32_t;
+    
+    // Dense ids for World resources, numbered independently of component ids so resource types
+    // do not use up signature bits.
+    class ResourceTypeRegistry {
+    public:
+        template<typename T>
+        static ResourceTypeID GetTypeID() {
+            static ResourceTypeID typeID = s_NextTypeID++;
+            return typeID;
+        }
+        
+        static ResourceTypeID GetNextTypeID() { return s_NextTypeID.load(); }
+    
+    private:
+        // atomic: systems on worker threads may be the first to look a resource type up
+        static std::atomic<ResourceTypeID> s_NextTypeID;
+    };
+
+}
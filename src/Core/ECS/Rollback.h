@@ -0,0 +1,215 @@
+#pragma once
+#include <cstdint>
+#include <cstring>
+#include <vector>
+#include <type_traits>
+#include "Entity.h"
+#include "Component.h"
+
+namespace UniversalEngine {
+    
+    // One recorded frame's undo data for one component type: for every entity whose component
+    // differs from the previous recorded frame, whether it had one then and, if so, its value.
+    struct RollbackDelta {
+        std::vector<EntityID> entities;
+        std::vector<std::uint8_t> hadComponent;
+        std::vector<unsigned char> values;  // one component per record with hadComponent set
+        
+        void Clear() {
+            entities.clear();
+            hadComponent.clear();
+            values.clear();
+        }
+        
+        void Push(EntityID entity, const unsigned char* previous, size_t size) {
+            entities.push_back(entity);
+            hadComponent.push_back(previous != nullptr);
+            if (previous) {
+                values.insert(values.end(), previous, previous + size);
+            }
+        }
+    };
+    
+    // One slot of World's rollback ring: everything needed to step the newest recorded state
+    // back to the one recorded before it.
+    struct RollbackFrame {
+        std::vector<EntityID> slots;                 // entity slots whose generation changed
+        std::vector<EntityGeneration> generations;   // and their previous generation
+        std::vector<EntityID> freeEntities;
+        size_t slotCount = 0;
+        size_t livingCount = 0;
+        std::vector<RollbackDelta> columns;          // parallel to World's rollback columns
+        
+        void Clear() {
+            slots.clear();
+            generations.clear();
+            freeEntities.clear();
+            for (RollbackDelta& delta : columns) {
+                delta.Clear();
+            }
+        }
+    };
+    
+    // Mirror of one component array as of the newest recorded frame, keyed by EntityID so it
+    // survives the array reordering itself. Only the recording needs the concrete type.
+    class IRollbackColumn {
+    public:
+        static constexpr std::uint32_t INVALID_INDEX = ~std::uint32_t(0);
+        
+        IRollbackColumn(ComponentTypeID typeID, IComponentArray* componentArray, size_t componentSize)
+            : m_TypeID(typeID), m_Array(componentArray), m_ComponentSize(componentSize) {}
+        virtual ~IRollbackColumn() = default;
+        
+        // appends the mirror's value of every entity whose component differs from the array's,
+        // then brings the mirror up to date
+        virtual void Record(RollbackDelta& delta) = 0;
+        
+        // makes the array's values match the mirror; entities that had no component are
+        // inserted and appended to gained
+        virtual void WriteBack(std::vector<EntityID>& gained) = 0;
+        
+        // steps the mirror back by one recorded frame
+        void Undo(const RollbackDelta& delta) {
+            size_t valueEnd = delta.values.size();
+            for (size_t k = delta.entities.size(); k-- > 0;) {
+                EntityID entity = delta.entities[k];
+                Assure(entity);
+                if (delta.hadComponent[k]) {
+                    valueEnd -= m_ComponentSize;
+                    AddMember(entity);
+                    std::memcpy(ValueOf(entity), &delta.values[valueEnd], m_ComponentSize);
+                } else {
+                    RemoveMember(entity);
+                }
+            }
+        }
+        
+        // entities whose component the array has but the mirror does not
+        void CollectRemoved(std::vector<EntityID>& removed) const {
+            const EntityID* entities = m_Array->EntityData();
+            for (size_t i = 0; i < m_Array->Size(); ++i) {
+                if (!IsMember(entities[i])) {
+                    removed.push_back(entities[i]);
+                }
+            }
+        }
+        
+        // forgets the mirror; the next Record() sees every component as new
+        void Reset() {
+            m_Values.clear();
+            m_MemberIndex.clear();
+            m_Members.clear();
+            m_Seen.clear();
+        }
+        
+        ComponentTypeID GetTypeID() const { return m_TypeID; }
+        IComponentArray* GetArray() const { return m_Array; }
+    
+    protected:
+        bool IsMember(EntityID entity) const {
+            return entity < m_MemberIndex.size() && m_MemberIndex[entity] != INVALID_INDEX;
+        }
+        
+        void Assure(EntityID entity) {
+            if (entity >= m_MemberIndex.size()) {
+                m_MemberIndex.resize(static_cast<size_t>(entity) + 1, INVALID_INDEX);
+                m_Seen.resize(static_cast<size_t>(entity) + 1, 0);
+                m_Values.resize((static_cast<size_t>(entity) + 1) * m_ComponentSize);
+            }
+        }
+        
+        unsigned char* ValueOf(EntityID entity) { return &m_Values[entity * m_ComponentSize]; }
+        
+        void AddMember(EntityID entity) {
+            if (m_MemberIndex[entity] == INVALID_INDEX) {
+                m_MemberIndex[entity] = static_cast<std::uint32_t>(m_Members.size());
+                m_Members.push_back(entity);
+            }
+        }
+        
+        void RemoveMember(EntityID entity) {
+            std::uint32_t index = m_MemberIndex[entity];
+            if (index == INVALID_INDEX) {
+                return;
+            }
+            m_Members[index] = m_Members.back();
+            m_MemberIndex[m_Members[index]] = index;
+            m_Members.pop_back();
+            m_MemberIndex[entity] = INVALID_INDEX;
+        }
+        
+        ComponentTypeID m_TypeID;
+        IComponentArray* m_Array;
+        size_t m_ComponentSize;
+        
+        std::vector<unsigned char> m_Values;       // m_ComponentSize bytes per EntityID
+        std::vector<std::uint32_t> m_MemberIndex;  // EntityID -> index in m_Members
+        std::vector<EntityID> m_Members;
+        std::vector<std::uint32_t> m_Seen;         // Record() epoch each entity was last visited in
+        std::uint32_t m_Epoch = 0;
+    };
+    
+    template<typename T>
+    class RollbackColumn : public IRollbackColumn {
+        static_assert(std::is_trivially_copyable_v<T>, "Rollback components must be trivially copyable");
+    
+    public:
+        explicit RollbackColumn(ComponentArray<T>* componentArray)
+            : IRollbackColumn(ComponentTypeRegistry::GetTypeID<T>(), componentArray, sizeof(T)), m_TypedArray(componentArray) {}
+        
+        // compares bytes rather than change ticks, so writes through plain GetComponent() are
+        // caught too; padding that differs only costs a redundant record
+        void Record(RollbackDelta& delta) override {
+            ++m_Epoch;
+            
+            const std::vector<EntityID>& entities = m_TypedArray->GetEntities();
+            for (size_t i = 0; i < entities.size(); ++i) {
+                EntityID entity = entities[i];
+                Assure(entity);
+                m_Seen[entity] = m_Epoch;
+                
+                const T& value = m_TypedArray->GetDataAt(i);
+                unsigned char* mirror = ValueOf(entity);
+                if (!IsMember(entity)) {
+                    delta.Push(entity, nullptr, sizeof(T));
+                    AddMember(entity);
+                } else if (std::memcmp(mirror, &value, sizeof(T)) != 0) {
+                    delta.Push(entity, mirror, sizeof(T));
+                } else {
+                    continue;
+                }
+                std::memcpy(mirror, &value, sizeof(T));
+            }
+            
+            // backwards, so the member swapped into a removed slot has already been checked
+            for (size_t k = m_Members.size(); k-- > 0;) {
+                EntityID entity = m_Members[k];
+                if (m_Seen[entity] != m_Epoch) {
+                    delta.Push(entity, ValueOf(entity), sizeof(T));
+                    RemoveMember(entity);
+                }
+            }
+        }
+        
+        void WriteBack(std::vector<EntityID>& gained) override {
+            for (EntityID entity : m_Members) {
+                const unsigned char* mirror = ValueOf(entity);
+                std::uint32_t index = m_TypedArray->GetIndex(entity);
+                
+                if (index == ComponentArray<T>::INVALID_INDEX) {
+                    alignas(T) unsigned char buffer[sizeof(T)];
+                    std::memcpy(buffer, mirror, sizeof(T));
+                    m_TypedArray->InsertMoved(entity, buffer);
+                    gained.push_back(entity);
+                } else if (std::memcmp(&m_TypedArray->GetDataAt(index), mirror, sizeof(T)) != 0) {
+                    std::memcpy(static_cast<void*>(&m_TypedArray->GetDataAt(index)), mirror, sizeof(T));
+                    m_TypedArray->MarkChangedAt(index);
+                }
+            }
+        }
+    
+    private:
+        ComponentArray<T>* m_TypedArray;
+    };
+
+}
@@ -0,0 +1,18 @@
+#pragma once
+#include <bitset>
+#include <cstddef>
+#include "Component.h"
+
+// Upper bound on distinct component types; override with -DUE_MAX_COMPONENTS=128 (or 256)
+#ifndef UE_MAX_COMPONENTS
+#define UE_MAX_COMPONENTS 64
+#endif
+
+namespace UniversalEngine {
+    
+    constexpr std::size_t MAX_COMPONENTS = UE_MAX_COMPONENTS;
+    
+    // one bit per ComponentTypeID
+    using Signature = std::bitset<MAX_COMPONENTS>;
+    
+}
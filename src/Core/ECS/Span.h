@@ -0,0 +1,39 @@
+#pragma once
+#include <cstddef>
+#include <vector>
+#include <type_traits>
+
+namespace UniversalEngine {
+    
+    // non-owning view over contiguous elements (std::span is C++20, the engine builds as C++17)
+    template<typename T>
+    class Span {
+    public:
+        Span() = default;
+        Span(T* data, std::size_t size) : m_Data(data), m_Size(size) {}
+        
+        template<typename U, typename = std::enable_if_t<std::is_convertible_v<U*, T*>>>
+        Span(std::vector<U>& vector) : m_Data(vector.data()), m_Size(vector.size()) {}
+        
+        template<typename U, typename = std::enable_if_t<std::is_convertible_v<const U*, T*>>>
+        Span(const std::vector<U>& vector) : m_Data(vector.data()), m_Size(vector.size()) {}
+        
+        T* data() const { return m_Data; }
+        std::size_t size() const { return m_Size; }
+        bool empty() const { return m_Size == 0; }
+        
+        T& operator[](std::size_t index) const { return m_Data[index]; }
+        
+        T* begin() const { return m_Data; }
+        T* end() const { return m_Data + m_Size; }
+        
+        Span subspan(std::size_t offset, std::size_t count) const {
+            return Span(m_Data + offset, count);
+        }
+    
+    private:
+        T* m_Data = nullptr;
+        std::size_t m_Size = 0;
+    };
+
+}
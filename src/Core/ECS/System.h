@@ -1,10 +1,12 @@
 #pragma once
 #include <cstdint>
-#include <set>
 #include <memory>
 #include <typeinfo>
 #include "Entity.h"
 #include "Component.h"
+#include "Signature.h"
+#include "EntitySet.h"
+#include "Span.h"
 
 namespace UniversalEngine {
     
@@ -23,56 +25,143 @@ namespace UniversalEngine {
         
         virtual void Init() {}
         virtual void Update(float deltaTime) {}
+        virtual void FixedUpdate(float fixedDeltaTime) {}
         virtual void Render() {}
         virtual void Shutdown() {}
         
         virtual void OnEntityAdded(Entity entity) {}
         virtual void OnEntityRemoved(Entity entity) {}
         
-        void SetSignature(const std::set<ComponentTypeID>& signature) {
+        // World reports membership changes once per flush (or per DestroyEntities/Instantiate
+        // call) as one span; override these to update acceleration structures in bulk.
+        // The defaults forward to the per-entity hooks.
+        virtual void OnEntitiesAdded(Span<const Entity> entities) {
+            for (Entity entity : entities) {
+                OnEntityAdded(entity);
+            }
+        }
+        
+        virtual void OnEntitiesRemoved(Span<const Entity> entities) {
+            for (Entity entity : entities) {
+                OnEntityRemoved(entity);
+            }
+        }
+        
+        void SetSignature(const Signature& signature) {
             m_Signature = signature;
         }
         
-        const std::set<ComponentTypeID>& GetSignature() const {
+        const Signature& GetSignature() const {
             return m_Signature;
         }
         
         void AddEntity(Entity entity) {
-            m_Entities.insert(entity);
-            OnEntityAdded(entity);
+            AddEntities(Span<const Entity>(&entity, 1));
         }
         
         void RemoveEntity(Entity entity) {
-            m_Entities.erase(entity);
-            OnEntityRemoved(entity);
+            RemoveEntities(Span<const Entity>(&entity, 1));
+        }
+        
+        void AddEntities(Span<const Entity> entities) {
+            m_Entities.Reserve(m_Entities.Size() + entities.size());
+            for (Entity entity : entities) {
+                m_Entities.Insert(entity);
+            }
+            OnEntitiesAdded(entities);
         }
         
-        const std::set<Entity>& GetEntities() const {
-            return m_Entities;
+        void RemoveEntities(Span<const Entity> entities) {
+            for (Entity entity : entities) {
+                m_Entities.Erase(entity);
+            }
+            OnEntitiesRemoved(entities);
+        }
+        
+        // contiguous; order is insertion order until an entity is removed or SortEntities is called
+        Span<const Entity> GetEntities() const {
+            return m_Entities.GetEntities();
         }
         
         size_t GetEntityCount() const {
-            return m_Entities.size();
+            return m_Entities.Size();
         }
         
         bool HasEntity(Entity entity) const {
-            return m_Entities.find(entity) != m_Entities.end();
+            return m_Entities.Contains(entity);
+        }
+        
+        template<typename Compare>
+        void SortEntities(Compare cmp) {
+            m_Entities.Sort(cmp);
+        }
+        
+        // Component access used by World's scheduler to run non-conflicting systems in parallel.
+        // A system that declares nothing is treated as touching everything and runs alone.
+        void DeclareAccess(const Signature& reads, const Signature& writes) {
+            m_Reads = reads;
+            m_Writes = writes;
+            m_AccessDeclared = true;
+            ++m_ScheduleVersion;
         }
         
-        void SetPriority(int priority) { m_Priority = priority; }
+        template<typename... Ts>
+        void DeclareReads() {
+            (m_Reads.set(ComponentTypeRegistry::GetTypeID<Ts>()), ...);
+            m_AccessDeclared = true;
+            ++m_ScheduleVersion;
+        }
+        
+        template<typename... Ts>
+        void DeclareWrites() {
+            (m_Writes.set(ComponentTypeRegistry::GetTypeID<Ts>()), ...);
+            m_AccessDeclared = true;
+            ++m_ScheduleVersion;
+        }
+        
+        bool HasDeclaredAccess() const { return m_AccessDeclared; }
+        const Signature& GetReads() const { return m_Reads; }
+        const Signature& GetWrites() const { return m_Writes; }
+        
+        bool ConflictsWith(const System& other) const {
+            if (!m_AccessDeclared || !other.m_AccessDeclared) {
+                return true;
+            }
+            return (m_Writes & (other.m_Reads | other.m_Writes)).any() || (other.m_Writes & m_Reads).any();
+        }
+        
+        // bumped whenever priority or declared access changes, so World knows to rebuild its schedule
+        std::uint32_t GetScheduleVersion() const { return m_ScheduleVersion; }
+        
+        void SetPriority(int priority) {
+            m_Priority = priority;
+            ++m_ScheduleVersion;
+        }
         int GetPriority() const { return m_Priority; }
         
         void SetEnabled(bool enabled) { m_Enabled = enabled; }
         bool IsEnabled() const { return m_Enabled; }
         
+        // World tick closed after this system's previous Update(); components stamped
+        // newer than it changed since then (see World::HasChangedSince, View::ChangedSince)
+        Tick GetLastRunTick() const { return m_LastRunTick; }
+        void SetLastRunTick(Tick tick) { m_LastRunTick = tick; }
+        
     protected:
-        std::set<Entity> m_Entities;
+        EntitySet m_Entities;
         
-        std::set<ComponentTypeID> m_Signature;
+        Signature m_Signature;
+        
+        Signature m_Reads;
+        Signature m_Writes;
+        bool m_AccessDeclared = false;
+        std::uint32_t m_ScheduleVersion = 0;
         
         int m_Priority = 0;
         
         bool m_Enabled = true;
+        
+        Tick m_LastRunTick = 0;
     };
     
     class SystemTypeRegistry {
@@ -106,9 +195,11 @@ namespace UniversalEngine {
         virtual void HandleEvent(const void* event) {}
     };
     
+    // simulation belongs in FixedUpdate(), which World::FixedUpdate() calls at a fixed rate
     class PhysicsSystem : public UpdateSystem {
     public:
-        virtual void FixedUpdate(float fixedDeltaTime) {}
+        void Update(float deltaTime) override {}
+        void FixedUpdate(float fixedDeltaTime) override {}
     };
     
 }
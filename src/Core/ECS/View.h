@@ -0,0 +1,202 @@
+#pragma once
+#include <cstddef>
+#include <array>
+#include <tuple>
+#include <vector>
+#include <iterator>
+#include <type_traits>
+#include <utility>
+#include "Entity.h"
+#include "Component.h"
+#include "../Jobs/JobSystem.h"
+
+namespace UniversalEngine {
+    
+    // calls fn(EntityID, T&) for every element of components, split into ranges of about
+    // grainSize elements, each a whole number of cache lines (see JobSystem::CacheAlignedGrain),
+    // run on jobSystem; fn must not add or remove components
+    template<typename T, typename Func>
+    void ParallelEach(JobSystem& jobSystem, ComponentArray<T>& components, Func&& fn, std::size_t grainSize = 1024) {
+        jobSystem.ParallelFor(components.Size(), JobSystem::CacheAlignedGrain<T>(grainSize),
+            [&components, &fn](std::size_t begin, std::size_t end) {
+                components.MarkChangedRange(begin, end);
+                const std::vector<EntityID>& entities = components.GetEntities();
+                for (std::size_t i = begin; i < end; ++i) {
+                    fn(entities[i], components.GetDataAt(i));
+                }
+            });
+    }
+    
+    // Joins several ComponentArrays. Iteration is driven by the smallest array and every
+    // other array is probed through its sparse index; no validity checks or exceptions.
+    // A const component type (View<const T>) yields const references; a non-const one
+    // stamps each visited element as changed at the World's current tick.
+    template<typename... Ts>
+    class ComponentView {
+        static constexpr std::size_t COMPONENT_COUNT = sizeof...(Ts);
+        
+        using Indices = std::array<std::uint32_t, COMPONENT_COUNT>;
+    
+    public:
+        class Iterator {
+        public:
+            using iterator_category = std::forward_iterator_tag;
+            using value_type = std::tuple<Entity, Ts&...>;
+            using difference_type = std::ptrdiff_t;
+            using pointer = void;
+            using reference = value_type;
+            
+            Iterator(const ComponentView* view, std::size_t position) : m_View(view), m_Position(position) {
+                Seek();
+            }
+            
+            value_type operator*() const {
+                return m_View->Fetch(m_Position, m_Indices, std::index_sequence_for<Ts...>());
+            }
+            
+            Iterator& operator++() {
+                ++m_Position;
+                Seek();
+                return *this;
+            }
+            
+            bool operator==(const Iterator& other) const { return m_Position == other.m_Position; }
+            bool operator!=(const Iterator& other) const { return m_Position != other.m_Position; }
+        
+        private:
+            void Seek() {
+                std::size_t end = m_View->DriverSize();
+                while (m_Position < end && !m_View->Probe(m_Position, m_Indices)) {
+                    ++m_Position;
+                }
+            }
+            
+            const ComponentView* m_View;
+            std::size_t m_Position;
+            Indices m_Indices{};
+        };
+        
+        ComponentView(const std::vector<EntityGeneration>* generations, ComponentArray<std::remove_const_t<Ts>>*... arrays)
+            : m_Generations(generations), m_Arrays(arrays...) {
+            SelectDriver(std::index_sequence_for<Ts...>());
+        }
+        
+        Iterator begin() const { return Iterator(this, 0); }
+        Iterator end() const { return Iterator(this, DriverSize()); }
+        
+        // calls fn(Entity, Ts&...) for every entity that has all of Ts
+        template<typename Func>
+        void Each(Func&& fn) const {
+            std::size_t size = DriverSize();
+            Indices indices;
+            for (std::size_t position = 0; position < size; ++position) {
+                if (Probe(position, indices)) {
+                    std::apply(fn, Fetch(position, indices, std::index_sequence_for<Ts...>()));
+                }
+            }
+        }
+        
+        // Each() with the driving array split across jobSystem; the other arrays are probed
+        // at scattered positions, so prefer an owning group for hot parallel loops
+        template<typename Func>
+        void ParallelEach(JobSystem& jobSystem, Func&& fn, std::size_t grainSize = 1024) const {
+            jobSystem.ParallelFor(DriverSize(), JobSystem::CacheAlignedGrain<EntityID>(grainSize),
+                [this, &fn](std::size_t begin, std::size_t end) {
+                    Indices indices;
+                    for (std::size_t position = begin; position < end; ++position) {
+                        if (Probe(position, indices)) {
+                            std::apply(fn, Fetch(position, indices, std::index_sequence_for<Ts...>()));
+                        }
+                    }
+                });
+        }
+        
+        // copy of this view that skips entities unless at least one of Us changed after since
+        template<typename... Us>
+        ComponentView ChangedSince(Tick since) const {
+            static_assert(sizeof...(Us) > 0, "ChangedSince needs at least one component type");
+            static_assert((IsOneOf<Us, std::remove_const_t<Ts>...> && ...), "Us must be part of the view");
+            
+            ComponentView view = *this;
+            view.m_ChangeFilter = { IsOneOf<std::remove_const_t<Ts>, std::remove_const_t<Us>...>... };
+            view.m_ChangedSince = since;
+            view.m_Filtered = true;
+            return view;
+        }
+        
+        // upper bound on the number of matches: the size of the smallest array
+        std::size_t SizeHint() const { return DriverSize(); }
+    
+    private:
+        template<typename T, typename... Us>
+        static constexpr bool IsOneOf = (std::is_same_v<std::remove_const_t<T>, Us> || ...);
+        
+        template<std::size_t... Is>
+        void SelectDriver(std::index_sequence<Is...>) {
+            bool missing = ((std::get<Is>(m_Arrays) == nullptr) || ...);
+            if (missing) {
+                return;
+            }
+            
+            std::size_t smallest = ~std::size_t(0);
+            ((std::get<Is>(m_Arrays)->Size() < smallest
+                ? (smallest = std::get<Is>(m_Arrays)->Size(), m_Driver = &std::get<Is>(m_Arrays)->GetEntities(), m_DriverIndex = Is)
+                : 0), ...);
+        }
+        
+        std::size_t DriverSize() const {
+            return m_Driver ? m_Driver->size() : 0;
+        }
+        
+        bool Probe(std::size_t position, Indices& indices) const {
+            return ProbeAll(position, indices, std::index_sequence_for<Ts...>());
+        }
+        
+        template<std::size_t... Is>
+        bool ProbeAll(std::size_t position, Indices& indices, std::index_sequence<Is...>) const {
+            EntityID entity = (*m_Driver)[position];
+            if (!(ProbeOne<Is>(entity, position, indices) && ...)) {
+                return false;
+            }
+            return !m_Filtered ||
+                   ((m_ChangeFilter[Is] && IsNewerTick(std::get<Is>(m_Arrays)->GetChangeTickAt(indices[Is]), m_ChangedSince)) || ...);
+        }
+        
+        template<std::size_t I>
+        bool ProbeOne(EntityID entity, std::size_t position, Indices& indices) const {
+            if (I == m_DriverIndex) {
+                indices[I] = static_cast<std::uint32_t>(position);
+                return true;
+            }
+            
+            indices[I] = std::get<I>(m_Arrays)->GetIndex(entity);
+            return indices[I] != ComponentArray<std::remove_const_t<std::tuple_element_t<I, std::tuple<Ts...>>>>::INVALID_INDEX;
+        }
+        
+        template<std::size_t... Is>
+        std::tuple<Entity, Ts&...> Fetch(std::size_t position, const Indices& indices, std::index_sequence<Is...>) const {
+            EntityID entity = (*m_Driver)[position];
+            return std::tuple<Entity, Ts&...>(Entity(entity, (*m_Generations)[entity]),
+                                              Access<Is>(indices[Is])...);
+        }
+        
+        template<std::size_t I>
+        decltype(auto) Access(std::uint32_t index) const {
+            auto* componentArray = std::get<I>(m_Arrays);
+            if constexpr (!std::is_const_v<std::tuple_element_t<I, std::tuple<Ts...>>>) {
+                componentArray->MarkChangedAt(index);
+            }
+            return componentArray->GetDataAt(index);
+        }
+        
+        const std::vector<EntityGeneration>* m_Generations;
+        std::tuple<ComponentArray<std::remove_const_t<Ts>>*...> m_Arrays;
+        const std::vector<EntityID>* m_Driver = nullptr;
+        std::size_t m_DriverIndex = 0;
+        
+        std::array<bool, COMPONENT_COUNT> m_ChangeFilter{};
+        Tick m_ChangedSince = 0;
+        bool m_Filtered = false;
+    };
+
+}
@@ -1,8 +1,50 @@
 #include "World.h"
+#include <string>
+#include <istream>
+#include <ostream>
+#include "../Jobs/JobSystem.h"
 
 namespace UniversalEngine {
     
-    World::World() : m_NextEntityID(1), m_LivingEntityCount(0) {
+    namespace {
+        
+        constexpr char SNAPSHOT_MAGIC[4] = { 'U', 'E', 'S', 'N' };
+        constexpr std::uint32_t SNAPSHOT_VERSION = 1;
+        
+        // followed by generations[slotCount], freeEntities[freeCount] and the column table;
+        // each column's data is entities[count] then count raw components
+        struct SnapshotHeader {
+            char magic[4];
+            std::uint32_t version;
+            std::uint32_t slotCount;
+            std::uint32_t freeCount;
+            std::uint32_t livingCount;
+            std::uint32_t columnCount;
+        };
+        
+        struct SnapshotColumn {
+            std::uint64_t nameHash;
+            std::uint32_t size;
+            std::uint32_t count;
+        };
+        
+        void WriteBytes(std::ostream& stream, const void* data, size_t size) {
+            stream.write(static_cast<const char*>(data), static_cast<std::streamsize>(size));
+        }
+        
+        void ReadBytes(std::istream& stream, void* data, size_t size) {
+            if (!stream.read(static_cast<char*>(data), static_cast<std::streamsize>(size))) {
+                throw std::runtime_error("Snapshot is truncated");
+            }
+        }
+        
+    }
+    
+    World::World(ComponentStorage storage)
+        : m_Generations(1, 0), m_Signatures(1), m_LivingEntityCount(0), m_Storage(storage), m_CommandBuffers(1) {
+        if (m_Storage == ComponentStorage::Archetype) {
+            m_Archetypes = std::make_unique<ArchetypeStorage>();
+        }
     }
     
     World::~World() {
@@ -10,74 +52,1002 @@ namespace UniversalEngine {
     }
     
     Entity World::CreateEntity() {
-        EntityID id;
+        ThrowIfStageRunning("CreateEntity");
         
-        if (!m_AvailableEntities.empty()) {
-            id = m_AvailableEntities.front();
-            m_AvailableEntities.pop();
-        } else {
-            id = m_NextEntityID++;
+        if (!m_FreeEntities.empty()) {
+            EntityID id = m_FreeEntities.back();
+            m_FreeEntities.pop_back();
+            ++m_Generations[id];
+            ++m_LivingEntityCount;
+            return Entity(id, m_Generations[id]);
+        }
+        
+        // fresh IDs come from the same counter as ReserveEntity(), so an ID reserved by a job
+        // meanwhile lands either below this one (and is materialized with it) or above it
+        EntityID id = m_NextEntityID.fetch_add(1, std::memory_order_relaxed);
+        MaterializeEntitiesBelow(id + 1);
+        return Entity(id, 1);
+    }
+    
+    void World::CreateEntities(size_t count, Span<Entity> out) {
+        if (out.size() < count) {
+            throw std::runtime_error("Output span is smaller than the entity count");
         }
+        ThrowIfStageRunning("CreateEntities");
         
-        ++m_LivingEntityCount;
+        // free slots first so create/destroy waves don't keep growing the tables; taken in
+        // ascending order, a batch destroyed together comes back as one contiguous run
+        size_t reused = std::min(count, m_FreeEntities.size());
+        auto reuseBegin = m_FreeEntities.end() - static_cast<std::ptrdiff_t>(reused);
+        std::sort(reuseBegin, m_FreeEntities.end());
+        for (size_t i = 0; i < reused; ++i) {
+            EntityID id = reuseBegin[static_cast<std::ptrdiff_t>(i)];
+            ++m_Generations[id];
+            out[i] = Entity(id, m_Generations[id]);
+        }
+        m_FreeEntities.erase(reuseBegin, m_FreeEntities.end());
+        m_LivingEntityCount += reused;
         
-        return Entity(id);
+        // the rest is one contiguous range of fresh IDs
+        size_t fresh = count - reused;
+        if (fresh == 0) {
+            return;
+        }
+        EntityID first = m_NextEntityID.fetch_add(static_cast<EntityID>(fresh), std::memory_order_relaxed);
+        MaterializeEntitiesBelow(first + static_cast<EntityID>(fresh));
+        
+        for (size_t i = 0; i < fresh; ++i) {
+            out[reused + i] = Entity(first + static_cast<EntityID>(i), 1);
+        }
     }
     
     void World::DestroyEntity(Entity entity) {
-        if (!IsEntityValid(entity)) {
+        DestroyEntities(Span<const Entity>(&entity, 1));
+    }
+    
+    void World::DestroyEntities(Span<const Entity> entities) {
+        ThrowIfStageRunning("DestroyEntities");
+        
+        m_DestroyBatch.clear();
+        Signature batchTypes;
+        
+        for (Entity entity : entities) {
+            if (IsEntityValid(entity)) {
+                m_DestroyBatch.push_back(entity);
+                batchTypes |= m_Signatures[entity.GetID()];
+            }
+        }
+        
+        if (m_DestroyBatch.empty()) {
+            return;
+        }
+        
+        // sorted by ID for locality; duplicates in the input are dropped
+        if (m_DestroyBatch.size() > 1) {
+            std::sort(m_DestroyBatch.begin(), m_DestroyBatch.end());
+            m_DestroyBatch.erase(std::unique(m_DestroyBatch.begin(), m_DestroyBatch.end()), m_DestroyBatch.end());
+        }
+        
+        // only systems referencing one of the batch's components can contain its entities
+        CollectSystems(batchTypes);
+        for (System* system : m_CandidateSystems) {
+            m_LeftBatch.clear();
+            for (Entity entity : m_DestroyBatch) {
+                if (system->HasEntity(entity)) {
+                    m_LeftBatch.push_back(entity);
+                }
+            }
+            if (!m_LeftBatch.empty()) {
+                system->RemoveEntities(m_LeftBatch);
+            }
+        }
+        
+        // observers run once the batch is gone and may destroy more, so they get their own copy
+        Signature observed = batchTypes & m_DestroyObserved;
+        std::vector<Entity> observedBatch;
+        std::vector<Signature> observedChanges;
+        if (observed.any()) {
+            observedBatch = m_DestroyBatch;
+            for (Entity entity : m_DestroyBatch) {
+                observedChanges.push_back(m_Signatures[entity.GetID()] & observed);
+            }
+        }
+        
+        if (!m_Groups.empty()) {
+            for (Entity entity : m_DestroyBatch) {
+                for (auto& group : m_Groups) {
+                    if (group->Contains(entity.GetID())) {
+                        group->Leave(entity.GetID());
+                    }
+                }
+            }
+        }
+        
+        // one pass per component type the batch actually has, instead of every array per entity
+        if (m_Storage == ComponentStorage::SparseSet) {
+            for (size_t typeID = 0; typeID < MAX_COMPONENTS; ++typeID) {
+                if (!batchTypes.test(typeID)) {
+                    continue;
+                }
+                
+                IComponentArray& componentArray = *m_ComponentArrays[static_cast<ComponentTypeID>(typeID)];
+                for (Entity entity : m_DestroyBatch) {
+                    if (m_Signatures[entity.GetID()].test(typeID)) {
+                        componentArray.EntityDestroyed(entity.GetID());
+                    }
+                }
+            }
+        } else {
+            for (Entity entity : m_DestroyBatch) {
+                m_Archetypes->DestroyEntity(entity.GetID());
+            }
+        }
+        
+        for (Entity entity : m_DestroyBatch) {
+            EntityID entityID = entity.GetID();
+            m_Signatures[entityID].reset();
+            ++m_Generations[entityID];
+            m_FreeEntities.push_back(entityID);
+        }
+        m_LivingEntityCount -= m_DestroyBatch.size();
+        
+        if (observed.any()) {
+            NotifyObservers(m_DestroyObservers, observed, observedBatch, observedChanges);
+        }
+    }
+    
+    void World::Instantiate(const Prefab& prefab, size_t count, Span<Entity> out) {
+        // before registering anything: workers may be reading m_ComponentArrays
+        ThrowIfStageRunning("Instantiate");
+        
+        prefab.ForEachComponent([this](const ComponentTypeInfo& typeInfo, const void*) {
+            RegisterComponentType(typeInfo);
+        });
+        
+        CreateEntities(count, out);
+        
+        const Signature& signature = prefab.GetSignature();
+        if (count == 0 || signature.none()) {
             return;
         }
         
-        EntityID entityID = entity.GetID();
+        m_InstantiateBatch.clear();
+        for (size_t i = 0; i < count; ++i) {
+            m_InstantiateBatch.push_back(out[i].GetID());
+        }
+        
+        if (m_Storage == ComponentStorage::SparseSet) {
+            prefab.ForEachComponent([this, count](const ComponentTypeInfo& typeInfo, const void* prototype) {
+                IComponentArray& componentArray = *m_ComponentArrays[typeInfo.id];
+                componentArray.InsertCopies(m_InstantiateBatch.data(), count, prototype);
+            });
+        } else {
+            std::array<const void*, MAX_COMPONENTS> prototypes{};
+            prefab.ForEachComponent([&prototypes](const ComponentTypeInfo& typeInfo, const void* prototype) {
+                prototypes[typeInfo.id] = prototype;
+            });
+            m_Archetypes->InsertCopies(signature, m_InstantiateBatch.data(), count, prototypes);
+        }
+        
+        for (EntityID entityID : m_InstantiateBatch) {
+            m_Signatures[entityID] = signature;
+        }
+        
+        if (!m_Groups.empty()) {
+            for (EntityID entityID : m_InstantiateBatch) {
+                UpdateGroups(entityID);
+            }
+        }
+        
+        // every instance has the same signature, so membership is decided once per system
+        Span<const Entity> instances(out.data(), count);
+        CollectSystems(signature);
+        for (System* system : m_CandidateSystems) {
+            if (SystemMatches(signature, system->GetSignature())) {
+                system->AddEntities(instances);
+            }
+        }
+        
+        Signature observed = signature & m_ConstructObserved;
+        for (size_t typeID = 0; observed.any() && typeID < MAX_COMPONENTS; ++typeID) {
+            if (observed.test(typeID)) {
+                CallObservers(m_ConstructObservers, static_cast<ComponentTypeID>(typeID), instances);
+            }
+        }
+    }
+    
+    Entity World::Instantiate(const Prefab& prefab) {
+        Entity entity;
+        Instantiate(prefab, 1, Span<Entity>(&entity, 1));
+        return entity;
+    }
+    
+    void World::MaterializeReservedEntities() {
+        MaterializeEntitiesBelow(m_NextEntityID.load(std::memory_order_relaxed));
+    }
+    
+    void World::MaterializeEntitiesBelow(EntityID end) {
+        if (m_Generations.size() >= end) {
+            return;
+        }
+        m_LivingEntityCount += end - m_Generations.size();
+        m_Generations.resize(end, 1);
+        m_Signatures.resize(end);
+    }
+    
+    void World::ThrowIfStageRunning(const char* operation) const {
+        if (m_ParallelStageRunning.load(std::memory_order_relaxed)) {
+            throw std::runtime_error(std::string(operation) + " cannot run while systems run in parallel; use ReserveEntity() and commands");
+        }
+    }
+    
+    void World::SaveSnapshot(std::ostream& stream) {
+        if (m_Storage != ComponentStorage::SparseSet) {
+            throw std::runtime_error("SaveSnapshot requires sparse-set component storage");
+        }
+        if (GetPendingOperationCount() != 0) {
+            throw std::runtime_error("SaveSnapshot requires an empty command buffer; call ecs_flush() first");
+        }
+        
+        MaterializeReservedEntities();
+        
+        // by type ID so the same World always writes the same bytes
+        std::vector<IComponentArray*> columns;
+        for (auto& [typeID, componentArray] : m_ComponentArrays) {
+            if (componentArray->GetTypeInfo().triviallyCopyable) {
+                columns.push_back(componentArray.get());
+            }
+        }
+        std::sort(columns.begin(), columns.end(), [](const IComponentArray* a, const IComponentArray* b) {
+            return a->GetTypeInfo().id < b->GetTypeInfo().id;
+        });
+        
+        SnapshotHeader header;
+        std::copy(std::begin(SNAPSHOT_MAGIC), std::end(SNAPSHOT_MAGIC), header.magic);
+        header.version = SNAPSHOT_VERSION;
+        header.slotCount = static_cast<std::uint32_t>(m_Generations.size());
+        header.freeCount = static_cast<std::uint32_t>(m_FreeEntities.size());
+        header.livingCount = static_cast<std::uint32_t>(m_LivingEntityCount);
+        header.columnCount = static_cast<std::uint32_t>(columns.size());
+        WriteBytes(stream, &header, sizeof(header));
+        WriteBytes(stream, m_Generations.data(), m_Generations.size() * sizeof(EntityGeneration));
+        WriteBytes(stream, m_FreeEntities.data(), m_FreeEntities.size() * sizeof(EntityID));
+        
+        for (IComponentArray* column : columns) {
+            SnapshotColumn entry;
+            entry.nameHash = column->GetTypeInfo().nameHash;
+            entry.size = static_cast<std::uint32_t>(column->GetTypeInfo().size);
+            entry.count = static_cast<std::uint32_t>(column->Size());
+            WriteBytes(stream, &entry, sizeof(entry));
+        }
+        
+        for (IComponentArray* column : columns) {
+            WriteBytes(stream, column->EntityData(), column->Size() * sizeof(EntityID));
+            column->ForEachRawRange([&stream](void* bytes, size_t size) {
+                WriteBytes(stream, bytes, size);
+            });
+        }
+        
+        if (!stream) {
+            throw std::runtime_error("Failed to write snapshot");
+        }
+    }
+    
+    void World::LoadSnapshot(std::istream& stream) {
+        if (m_Storage != ComponentStorage::SparseSet) {
+            throw std::runtime_error("LoadSnapshot requires sparse-set component storage");
+        }
+        if (GetPendingOperationCount() != 0) {
+            throw std::runtime_error("LoadSnapshot requires an empty command buffer; call ecs_flush() first");
+        }
+        
+        SnapshotHeader header;
+        ReadBytes(stream, &header, sizeof(header));
+        if (!std::equal(std::begin(SNAPSHOT_MAGIC), std::end(SNAPSHOT_MAGIC), header.magic)) {
+            throw std::runtime_error("Not a World snapshot");
+        }
+        if (header.version != SNAPSHOT_VERSION) {
+            throw std::runtime_error("Unsupported snapshot version " + std::to_string(header.version));
+        }
+        if (header.slotCount == 0 || header.freeCount >= header.slotCount || header.livingCount >= header.slotCount) {
+            throw std::runtime_error("Snapshot entity table is corrupt");
+        }
+        
+        std::vector<EntityGeneration> generations(header.slotCount);
+        std::vector<EntityID> freeEntities(header.freeCount);
+        std::vector<SnapshotColumn> table(header.columnCount);
+        ReadBytes(stream, generations.data(), generations.size() * sizeof(EntityGeneration));
+        ReadBytes(stream, freeEntities.data(), freeEntities.size() * sizeof(EntityID));
+        ReadBytes(stream, table.data(), table.size() * sizeof(SnapshotColumn));
+        
+        // the entity table must hold up on its own: CreateEntity() trusts the free list and
+        // IsEntityValid() the generations
+        size_t livingSlots = 0;
+        for (size_t slot = 1; slot < generations.size(); ++slot) {
+            livingSlots += generations[slot] & 1;
+        }
+        if (livingSlots != header.livingCount) {
+            throw std::runtime_error("Snapshot entity table is corrupt");
+        }
+        std::vector<bool> freed(header.slotCount, false);
+        for (EntityID entityID : freeEntities) {
+            if (entityID == INVALID_ENTITY || entityID >= header.slotCount || (generations[entityID] & 1) != 0 || freed[entityID]) {
+                throw std::runtime_error("Snapshot entity table is corrupt");
+            }
+            freed[entityID] = true;
+        }
+        
+        // every column is matched to a registered array before the World is touched
+        std::vector<IComponentArray*> columns;
+        std::vector<std::uint32_t> counts;
+        for (const SnapshotColumn& entry : table) {
+            IComponentArray* target = nullptr;
+            for (auto& [typeID, componentArray] : m_ComponentArrays) {
+                if (componentArray->GetTypeInfo().nameHash == entry.nameHash) {
+                    target = componentArray.get();
+                    break;
+                }
+            }
+            
+            if (!target) {
+                throw std::runtime_error("Snapshot contains a component type that is not registered");
+            }
+            if (target->GetTypeInfo().size != entry.size || !target->GetTypeInfo().triviallyCopyable ||
+                std::find(columns.begin(), columns.end(), target) != columns.end()) {
+                throw std::runtime_error("Snapshot component column does not match its registered type");
+            }
+            if (entry.count > header.livingCount) {
+                throw std::runtime_error("Snapshot component column is corrupt");
+            }
+            columns.push_back(target);
+            counts.push_back(entry.count);
+        }
+        
+        ClearForLoad();
+        
+        m_Generations = std::move(generations);
+        m_Generations[0] = 0;
+        m_FreeEntities = std::move(freeEntities);
+        m_Signatures.assign(m_Generations.size(), Signature());
+        m_LivingEntityCount = header.livingCount;
+        m_NextEntityID.store(header.slotCount, std::memory_order_relaxed);
+        
+        try {
+            ReadSnapshotColumns(stream, columns, counts);
+        } catch (...) {
+            ClearForLoad();
+            m_Generations.assign(1, 0);
+            m_Signatures.assign(1, Signature());
+            m_FreeEntities.clear();
+            m_LivingEntityCount = 0;
+            m_NextEntityID.store(1, std::memory_order_relaxed);
+            throw;
+        }
+        
+        if (!m_Groups.empty()) {
+            for (EntityID entityID = 1; entityID < m_Signatures.size(); ++entityID) {
+                if (m_Signatures[entityID].any()) {
+                    UpdateGroups(entityID);
+                }
+            }
+        }
+        
+        for (auto& system : m_SystemsVector) {
+            const Signature& systemSignature = system->GetSignature();
+            m_EnteredBatch.clear();
+            for (EntityID entityID = 1; entityID < m_Signatures.size(); ++entityID) {
+                if (SystemMatches(m_Signatures[entityID], systemSignature)) {
+                    m_EnteredBatch.push_back(GetEntity(entityID));
+                }
+            }
+            if (!m_EnteredBatch.empty()) {
+                system->AddEntities(m_EnteredBatch);
+            }
+        }
+    }
+    
+    void World::ClearForLoad() {
+        for (auto& system : m_SystemsVector) {
+            if (system->GetEntityCount() != 0) {
+                m_LeftBatch.assign(system->GetEntities().begin(), system->GetEntities().end());
+                system->RemoveEntities(m_LeftBatch);
+            }
+        }
+        
+        for (auto& group : m_Groups) {
+            group->size = 0;
+        }
+        for (AlignmentPass& pass : m_AlignmentPasses) {
+            pass.cursor = 0;
+            std::fill(pass.next.begin(), pass.next.end(), 0);
+        }
+        for (auto& [typeID, componentArray] : m_ComponentArrays) {
+            componentArray->Clear();
+        }
         
-        m_Signatures[entityID].clear();
+        // recorded frames describe the World being replaced
+        for (RollbackFrame& frame : m_RollbackFrames) {
+            frame.Clear();
+        }
+        for (auto& column : m_RollbackColumns) {
+            column->Reset();
+        }
+        m_RollbackHead = 0;
+        m_RollbackCount = 0;
+        m_RollbackGenerations.clear();
+        m_RollbackFreeEntities.clear();
+        m_RollbackLivingCount = 0;
+    }
+    
+    void World::ReadSnapshotColumns(std::istream& stream, const std::vector<IComponentArray*>& columns,
+                                    const std::vector<std::uint32_t>& counts) {
+        std::vector<EntityID> entities;
+        for (size_t k = 0; k < columns.size(); ++k) {
+            ComponentTypeID typeID = columns[k]->GetTypeInfo().id;
+            
+            entities.resize(counts[k]);
+            ReadBytes(stream, entities.data(), entities.size() * sizeof(EntityID));
+            for (EntityID entityID : entities) {
+                if (!GetEntity(entityID).IsValid() || m_Signatures[entityID].test(typeID)) {
+                    throw std::runtime_error("Snapshot component column is corrupt");
+                }
+                m_Signatures[entityID].set(typeID);
+            }
+            
+            // straight into the array's storage, no per-entity insert
+            columns[k]->Assign(entities.data(), entities.size());
+            columns[k]->ForEachRawRange([&stream](void* bytes, size_t size) {
+                ReadBytes(stream, bytes, size);
+            });
+        }
+    }
+    
+    void World::RecordFrame() {
+        if (m_RollbackFrames.empty()) {
+            throw std::runtime_error("RecordFrame requires EnableRollback");
+        }
+        
+        MaterializeReservedEntities();
         
-        for (auto const& pair : m_ComponentArrays) {
-            auto const& component = pair.second;
-            component->EntityDestroyed(entityID);
+        m_RollbackHead = (m_RollbackHead + 1) % m_RollbackFrames.size();
+        RollbackFrame& frame = m_RollbackFrames[m_RollbackHead];
+        frame.Clear();
+        frame.columns.resize(m_RollbackColumns.size());
+        
+        // the entity table's undo data is the previous generation of every slot that changed
+        frame.slotCount = m_RollbackGenerations.size();
+        frame.freeEntities = m_RollbackFreeEntities;
+        frame.livingCount = m_RollbackLivingCount;
+        
+        size_t slotCount = std::max(m_Generations.size(), m_RollbackGenerations.size());
+        m_RollbackGenerations.resize(slotCount, 0);
+        for (size_t slot = 0; slot < slotCount; ++slot) {
+            EntityGeneration current = slot < m_Generations.size() ? m_Generations[slot] : 0;
+            if (current != m_RollbackGenerations[slot]) {
+                frame.slots.push_back(static_cast<EntityID>(slot));
+                frame.generations.push_back(m_RollbackGenerations[slot]);
+                m_RollbackGenerations[slot] = current;
+            }
         }
         
-        for (auto const& pair : m_Systems) {
-            auto const& system = pair.second;
-            system->RemoveEntity(entity);
+        m_RollbackGenerations.resize(m_Generations.size());
+        m_RollbackFreeEntities = m_FreeEntities;
+        m_RollbackLivingCount = m_LivingEntityCount;
+        
+        for (size_t c = 0; c < m_RollbackColumns.size(); ++c) {
+            m_RollbackColumns[c]->Record(frame.columns[c]);
         }
         
-        m_AvailableEntities.push(entityID);
-        --m_LivingEntityCount;
+        m_RollbackCount = std::min(m_RollbackCount + 1, m_RollbackFrames.size());
     }
     
-    bool World::IsEntityValid(Entity entity) const {
-        EntityID entityID = entity.GetID();
-        if (entityID == INVALID_ENTITY || entityID >= m_NextEntityID) {
-            return false;
+    void World::Rewind(size_t frames) {
+        if (m_RollbackCount == 0 || frames >= m_RollbackCount) {
+            throw std::runtime_error("Cannot rewind further than the recorded history");
+        }
+        if (GetPendingOperationCount() != 0) {
+            throw std::runtime_error("Rewind requires an empty command buffer; call ecs_flush() first");
+        }
+        
+        MaterializeReservedEntities();
+        
+        // step the mirrors back to the target frame, newest frame first
+        for (size_t step = 0; step < frames; ++step) {
+            UndoRollbackFrame(m_RollbackFrames[m_RollbackHead]);
+            m_RollbackHead = (m_RollbackHead + m_RollbackFrames.size() - 1) % m_RollbackFrames.size();
+        }
+        m_RollbackCount -= frames;
+        
+        ApplyRollbackState();
+    }
+    
+    void World::UndoRollbackFrame(RollbackFrame& frame) {
+        m_RollbackGenerations.resize(std::max(m_RollbackGenerations.size(), frame.slotCount), 0);
+        for (size_t k = 0; k < frame.slots.size(); ++k) {
+            m_RollbackGenerations[frame.slots[k]] = frame.generations[k];
+        }
+        m_RollbackGenerations.resize(frame.slotCount);
+        m_RollbackFreeEntities = frame.freeEntities;
+        m_RollbackLivingCount = frame.livingCount;
+        
+        for (size_t c = 0; c < m_RollbackColumns.size(); ++c) {
+            m_RollbackColumns[c]->Undo(frame.columns[c]);
+        }
+    }
+    
+    void World::ApplyRollbackState() {
+        // live entities the restored state does not have, or has under another generation,
+        // are destroyed the normal way so systems, groups and observers see them go
+        std::vector<Entity> stale;
+        for (EntityID entityID = 1; entityID < m_Generations.size(); ++entityID) {
+            Entity entity = GetEntity(entityID);
+            if (entity.IsValid() && (entityID >= m_RollbackGenerations.size() ||
+                                     m_RollbackGenerations[entityID] != m_Generations[entityID])) {
+                stale.push_back(entity);
+            }
+        }
+        if (!stale.empty()) {
+            DestroyEntities(stale);
+        }
+        
+        // slots alive in the restored state are now either untouched or dead with no components
+        m_Generations = m_RollbackGenerations;
+        m_Signatures.resize(m_Generations.size());
+        m_FreeEntities = m_RollbackFreeEntities;
+        m_LivingEntityCount = m_RollbackLivingCount;
+        m_NextEntityID.store(static_cast<EntityID>(m_Generations.size()), std::memory_order_relaxed);
+        
+        // then the rollback components are diffed back in like one flush
+        ++m_FlushID;
+        m_TouchedEntities.clear();
+        m_TouchedSignatures.clear();
+        
+        std::vector<EntityID> changed;
+        for (const auto& column : m_RollbackColumns) {
+            ComponentTypeID typeID = column->GetTypeID();
+            IComponentArray& componentArray = *column->GetArray();
+            
+            changed.clear();
+            column->CollectRemoved(changed);
+            for (EntityID entityID : changed) {
+                TouchEntity(entityID);
+                GroupData* group = m_GroupOwners[typeID];
+                if (group && group->Contains(entityID)) {
+                    group->Leave(entityID);
+                }
+                componentArray.Remove(entityID);
+                m_Signatures[entityID].reset(typeID);
+            }
+            
+            changed.clear();
+            column->WriteBack(changed);
+            for (EntityID entityID : changed) {
+                TouchEntity(entityID);
+                m_Signatures[entityID].set(typeID);
+            }
         }
         
-        // check if entity is in the available entities queue (destroyed)
-        std::queue<EntityID> tempQueue = m_AvailableEntities;
-        while (!tempQueue.empty()) {
-            if (tempQueue.front() == entityID) {
-                return false;
+        if (!m_Groups.empty()) {
+            for (EntityID entityID : m_TouchedEntities) {
+                UpdateGroups(entityID);
             }
-            tempQueue.pop();
         }
         
-        return true;
+        UpdateTouchedSystems();
+        NotifyTouchedObservers();
+    }
+    
+    void World::SetJobSystem(JobSystem* jobSystem) {
+        if (GetPendingOperationCount() != 0) {
+            throw std::runtime_error("SetJobSystem requires an empty command buffer; call ecs_flush() first");
+        }
+        
+        m_JobSystem = jobSystem;
+        m_CommandBuffers.clear();
+        m_CommandBuffers.resize(jobSystem ? jobSystem->GetThreadCount() : 1);
+    }
+    
+    size_t World::GetPendingOperationCount() const {
+        size_t count = 0;
+        for (const CommandBuffer& buffer : m_CommandBuffers) {
+            count += buffer.GetCommandCount();
+        }
+        return count;
+    }
+    
+    void World::RegisterComponentType(const ComponentTypeInfo& typeInfo) {
+        if (IsComponentRegistered(typeInfo.id)) {
+            return;
+        }
+        
+        if (typeInfo.id >= MAX_COMPONENTS) {
+            throw std::runtime_error("Too many component types, raise UE_MAX_COMPONENTS");
+        }
+        
+        if (m_Storage == ComponentStorage::Archetype) {
+            m_Archetypes->RegisterType(typeInfo);
+            return;
+        }
+        
+        m_ComponentArrays[typeInfo.id] = typeInfo.createArray();
+        m_ComponentArrays[typeInfo.id]->SetTickSource(&m_Tick);
     }
     
     void World::ecs_flush() {
-        for (auto& operation : m_PendingOperations) {
-            operation.operation();
+        ThrowIfStageRunning("ecs_flush");
+        MaterializeReservedEntities();
+        
+        // everything stamped so far is applied below, so the stamps can start over
+        JobSystem::ResetSubmissionOrder();
+        
+        if (GetPendingOperationCount() == 0) {
+            return;
+        }
+        
+        ++m_FlushID;
+        m_TouchedEntities.clear();
+        m_TouchedSignatures.clear();
+        
+        CollectPendingCommands();
+        for (const PendingCommands& pending : m_PendingCommands) {
+            ApplyCommands(pending);
+        }
+        
+        // archetype moves happen in bulk, one per touched entity, while the staged
+        // components still live in the command arenas
+        if (m_Storage == ComponentStorage::Archetype) {
+            m_Archetypes->Commit(m_TouchedEntities);
+            
+            for (EntityID entityID : m_TouchedEntities) {
+                m_TouchedSignatures.push_back(m_Signatures[entityID]);
+                m_Signatures[entityID] = m_Archetypes->GetSignature(entityID);
+            }
+        }
+        
+        for (CommandBuffer& buffer : m_CommandBuffers) {
+            buffer.Clear();
+        }
+        
+        if (!m_Groups.empty()) {
+            for (EntityID entityID : m_TouchedEntities) {
+                UpdateGroups(entityID);
+            }
+        }
+        
+        UpdateTouchedSystems();
+        NotifyTouchedObservers();
+    }
+    
+    void World::CollectPendingCommands() {
+        static constexpr size_t NONE = ~size_t(0);
+        
+        m_PendingCommands.clear();
+        std::array<size_t, MAX_COMPONENTS> slots;
+        slots.fill(NONE);
+        size_t mergedCount = 0;
+        
+        auto startMerge = [this, &mergedCount](PendingCommands& pending) {
+            if (mergedCount == m_MergedCommands.size()) {
+                m_MergedCommands.emplace_back();
+            }
+            std::vector<ComponentCommand>& merged = m_MergedCommands[mergedCount];
+            merged.assign(pending.commands->begin(), pending.commands->end());
+            pending.commands = &merged;
+            pending.merged = mergedCount++;
+        };
+        
+        // gather each type's queues across the thread buffers
+        for (CommandBuffer& buffer : m_CommandBuffers) {
+            buffer.ForEachQueue([&](ComponentCommandQueue& queue) {
+                size_t& slot = slots[queue.typeInfo.id];
+                if (slot == NONE) {
+                    slot = m_PendingCommands.size();
+                    m_PendingCommands.push_back({ &queue.typeInfo, &queue.commands, queue.addCount, NONE });
+                    return;
+                }
+                
+                PendingCommands& pending = m_PendingCommands[slot];
+                if (pending.merged == NONE) {
+                    startMerge(pending);
+                }
+                std::vector<ComponentCommand>& merged = m_MergedCommands[pending.merged];
+                merged.insert(merged.end(), queue.commands.begin(), queue.commands.end());
+                pending.addCount += queue.addCount;
+            });
+        }
+        
+        // a single thread's queue is usually in order already (the main thread's always is)
+        auto earlier = [](const ComponentCommand& a, const ComponentCommand& b) { return a.order < b.order; };
+        for (PendingCommands& pending : m_PendingCommands) {
+            if (std::is_sorted(pending.commands->begin(), pending.commands->end(), earlier)) {
+                continue;
+            }
+            if (pending.merged == NONE) {
+                startMerge(pending);
+            }
+            std::vector<ComponentCommand>& merged = m_MergedCommands[pending.merged];
+            std::stable_sort(merged.begin(), merged.end(), earlier);
+        }
+        
+        // types in the order of their first command, so entities are touched as a serial run would
+        std::stable_sort(m_PendingCommands.begin(), m_PendingCommands.end(),
+            [](const PendingCommands& a, const PendingCommands& b) {
+                return a.commands->front().order < b.commands->front().order;
+            });
+    }
+    
+    void World::ApplyCommands(const PendingCommands& pending) {
+        ComponentTypeID typeID = pending.typeInfo->id;
+        RegisterComponentType(*pending.typeInfo);
+        
+        if (m_Storage == ComponentStorage::Archetype) {
+            for (const ComponentCommand& command : *pending.commands) {
+                if (!IsEntityValid(command.entity)) {
+                    continue;
+                }
+                if (command.type == CommandType::AddComponent) {
+                    m_Archetypes->StageInsert(command.entity.GetID(), typeID, command.payload);
+                } else {
+                    m_Archetypes->StageRemove(command.entity.GetID(), typeID);
+                }
+            }
+            return;
+        }
+        
+        IComponentArray& componentArray = *m_ComponentArrays[typeID];
+        componentArray.Reserve(componentArray.Size() + pending.addCount);
+        
+        for (const ComponentCommand& command : *pending.commands) {
+            if (!IsEntityValid(command.entity)) {
+                continue;
+            }
+            
+            EntityID entityID = command.entity.GetID();
+            TouchEntity(entityID);
+            
+            if (command.type == CommandType::AddComponent) {
+                componentArray.InsertMoved(entityID, command.payload);
+                m_Signatures[entityID].set(typeID);
+            } else {
+                // leave the owning group first so the swap-remove happens outside its packed prefix
+                GroupData* group = m_GroupOwners[typeID];
+                if (group && group->Contains(entityID)) {
+                    group->Leave(entityID);
+                }
+                componentArray.Remove(entityID);
+                m_Signatures[entityID].reset(typeID);
+            }
+        }
+    }
+    
+    GroupData* World::FindGroup(const Signature& owned) {
+        for (auto& group : m_Groups) {
+            if (group->owned == owned) {
+                return group.get();
+            }
+        }
+        return nullptr;
+    }
+    
+    GroupData* World::CreateGroup(const Signature& owned, std::vector<IComponentArray*> arrays) {
+        for (size_t typeID = 0; typeID < MAX_COMPONENTS; ++typeID) {
+            if (owned.test(typeID) && m_GroupOwners[typeID]) {
+                throw std::runtime_error("Component type is already owned by another group");
+            }
+        }
+        
+        auto group = std::make_unique<GroupData>();
+        group->owned = owned;
+        group->arrays = std::move(arrays);
+        
+        for (EntityID entityID = 1; entityID < m_Signatures.size(); ++entityID) {
+            if (SignatureMatches(m_Signatures[entityID], owned)) {
+                group->Enter(entityID);
+            }
+        }
+        
+        for (size_t typeID = 0; typeID < MAX_COMPONENTS; ++typeID) {
+            if (owned.test(typeID)) {
+                m_GroupOwners[typeID] = group.get();
+            }
+        }
+        
+        m_Groups.push_back(std::move(group));
+        return m_Groups.back().get();
+    }
+    
+    void World::UpdateGroups(EntityID entityID) {
+        for (auto& group : m_Groups) {
+            if (!group->Contains(entityID) && group->Matches(entityID)) {
+                group->Enter(entityID);
+            }
         }
-        m_PendingOperations.clear();
     }
     
     void World::Update(float deltaTime) {
-        for (auto& system : m_SystemsVector) {
+        if (IsScheduleStale()) {
+            BuildSchedule();
+        }
+        
+        Defragment();
+        
+        for (const auto& stage : m_Stages) {
+            RunStage(stage, &System::Update, deltaTime);
+            
+            // a system's own writes are older than its last-run tick on the next frame
+            Tick ran = AdvanceTick();
+            for (System* system : stage) {
+                if (system->IsEnabled()) {
+                    system->SetLastRunTick(ran);
+                }
+            }
+        }
+    }
+    
+    void World::FixedUpdate(float fixedDeltaTime) {
+        if (IsScheduleStale()) {
+            BuildSchedule();
+        }
+        
+        // each stage closes a tick, so writes from one step compare older than the next
+        // step's; last-run ticks stay with Update(), which is what most systems read them in
+        for (const auto& stage : m_Stages) {
+            RunStage(stage, &System::FixedUpdate, fixedDeltaTime);
+            AdvanceTick();
+        }
+    }
+    
+    void World::ThrowIfNotReorderable(ComponentTypeID typeID, const char* operation) const {
+        if (m_Storage != ComponentStorage::SparseSet) {
+            throw std::runtime_error(std::string(operation) + " requires sparse-set component storage");
+        }
+        if (typeID < MAX_COMPONENTS && m_GroupOwners[typeID]) {
+            throw std::runtime_error(std::string(operation) + " cannot reorder a component type owned by a group");
+        }
+    }
+    
+    size_t World::AdvanceAlignment(AlignmentPass& pass, size_t budget) {
+        auto primaryIt = m_ComponentArrays.find(pass.primary);
+        if (primaryIt == m_ComponentArrays.end()) {
+            return 0;
+        }
+        IComponentArray& primary = *primaryIt->second;
+        
+        // a group created since the pass was set up owns its arrays' order; leave those alone
+        std::array<IComponentArray*, MAX_COMPONENTS> others{};
+        for (size_t k = 0; k < pass.others.size(); ++k) {
+            auto it = m_ComponentArrays.find(pass.others[k]);
+            if (it != m_ComponentArrays.end() && !m_GroupOwners[pass.others[k]]) {
+                others[k] = it->second.get();
+            }
+        }
+        
+        size_t visited = 0;
+        while (visited < budget) {
+            if (pass.cursor >= primary.Size()) {
+                pass.cursor = 0;
+                std::fill(pass.next.begin(), pass.next.end(), 0);
+                break;
+            }
+            
+            EntityID entity = primary.EntityAt(pass.cursor++);
+            ++visited;
+            
+            for (size_t k = 0; k < pass.others.size(); ++k) {
+                if (!others[k]) {
+                    continue;
+                }
+                
+                // an entity already inside the prefix was moved there by a swap-remove since
+                // the pass started; it is put right on the next pass
+                std::uint32_t index = others[k]->IndexOf(entity);
+                if (index != IComponentArray::INVALID_INDEX && index >= pass.next[k]) {
+                    others[k]->SwapEntries(index, pass.next[k]);
+                    ++pass.next[k];
+                }
+            }
+        }
+        return visited;
+    }
+    
+    void World::Defragment() {
+        size_t budget = m_DefragmentationBudget;
+        for (AlignmentPass& pass : m_AlignmentPasses) {
+            if (budget == 0) {
+                break;
+            }
+            budget -= AdvanceAlignment(pass, budget);
+        }
+    }
+    
+    size_t World::GetScheduleStageCount() {
+        if (IsScheduleStale()) {
+            BuildSchedule();
+        }
+        return m_Stages.size();
+    }
+    
+    bool World::IsScheduleStale() const {
+        if (m_ScheduledVersions.size() != m_SystemsVector.size()) {
+            return true;
+        }
+        for (size_t i = 0; i < m_SystemsVector.size(); ++i) {
+            if (m_SystemsVector[i]->GetScheduleVersion() != m_ScheduledVersions[i]) {
+                return true;
+            }
+        }
+        return false;
+    }
+    
+    void World::BuildSchedule() {
+        std::stable_sort(m_SystemsVector.begin(), m_SystemsVector.end(),
+            [](const std::shared_ptr<System>& a, const std::shared_ptr<System>& b) {
+                return a->GetPriority() < b->GetPriority();
+            });
+        
+        // each system lands one stage after the latest earlier (by priority) system it conflicts
+        // with; that is the longest path in the conflict DAG, so stages can run back to back
+        m_Stages.clear();
+        std::vector<size_t> levels(m_SystemsVector.size(), 0);
+        
+        for (size_t j = 0; j < m_SystemsVector.size(); ++j) {
+            for (size_t i = 0; i < j; ++i) {
+                if (levels[i] + 1 > levels[j] && m_SystemsVector[i]->ConflictsWith(*m_SystemsVector[j])) {
+                    levels[j] = levels[i] + 1;
+                }
+            }
+            
+            if (levels[j] >= m_Stages.size()) {
+                m_Stages.resize(levels[j] + 1);
+            }
+            m_Stages[levels[j]].push_back(m_SystemsVector[j].get());
+        }
+        
+        m_ScheduledVersions.clear();
+        for (const auto& system : m_SystemsVector) {
+            m_ScheduledVersions.push_back(system->GetScheduleVersion());
+        }
+    }
+    
+    void World::RunStage(const std::vector<System*>& stage, SystemStep step, float deltaTime) {
+        // each system is ordered as a spawned job either way, so its commands merge into the
+        // same place whether the stage runs serially or across workers
+        if (stage.size() == 1 || !m_JobSystem || m_JobSystem->GetWorkerCount() == 0) {
+            for (System* system : stage) {
+                if (system->IsEnabled()) {
+                    JobSystem::RunInline([system, step, deltaTime]() { (system->*step)(deltaTime); });
+                }
+            }
+            return;
+        }
+        
+        // entity slots must not be reallocated under jobs that validate handles
+        struct StageFlag {
+            std::atomic<bool>& running;
+            explicit StageFlag(std::atomic<bool>& flag) : running(flag) { running.store(true, std::memory_order_relaxed); }
+            ~StageFlag() { running.store(false, std::memory_order_relaxed); }
+        } stageFlag(m_ParallelStageRunning);
+        
+        // the calling thread takes the last system itself, then helps with the rest in Wait();
+        // spawning in stage order keeps the command order the serial branch gives
+        JobCounter counter;
+        System* last = stage.back();
+        for (size_t i = 0; i + 1 < stage.size(); ++i) {
+            System* system = stage[i];
             if (system->IsEnabled()) {
-                system->Update(deltaTime);
+                m_JobSystem->Run(counter, [system, step, deltaTime]() { (system->*step)(deltaTime); });
+            }
+        }
+        
+        try {
+            if (last->IsEnabled()) {
+                JobSystem::RunInline([last, step, deltaTime]() { (last->*step)(deltaTime); });
             }
+        } catch (...) {
+            m_JobSystem->WaitWithoutRethrow(counter);
+            throw;
         }
+        m_JobSystem->Wait(counter);
     }
     
     void World::Render() {
@@ -94,33 +1064,166 @@ namespace UniversalEngine {
         }
         m_Systems.clear();
         m_SystemsVector.clear();
+        m_Stages.clear();
+        m_ScheduledVersions.clear();
+        for (auto& systems : m_ComponentSystems) {
+            systems.clear();
+        }
+        for (size_t typeID = 0; typeID < MAX_COMPONENTS; ++typeID) {
+            m_ConstructObservers[typeID].clear();
+            m_DestroyObservers[typeID].clear();
+        }
+        m_ConstructObserved.reset();
+        m_DestroyObserved.reset();
+        m_Groups.clear();
+        m_GroupOwners.fill(nullptr);
+        m_AlignmentPasses.clear();
+        m_RollbackColumns.clear();
+        m_RollbackFrames.clear();
+        m_RollbackCount = 0;
         m_ComponentArrays.clear();
-        m_PendingOperations.clear();
+        m_Resources.clear();
+        for (CommandBuffer& buffer : m_CommandBuffers) {
+            buffer.Clear();
+        }
+        
+        if (m_Archetypes) {
+            m_Archetypes = std::make_unique<ArchetypeStorage>();
+        }
     }
     
-    void World::UpdateEntitySystems(Entity entity) {
-        EntityID entityID = entity.GetID();
-        const Signature& entitySignature = m_Signatures[entityID];
+    void World::UpdateTouchedSystems() {
+        // only systems that reference a component which actually changed can change membership
+        Signature changedTypes;
+        for (size_t i = 0; i < m_TouchedEntities.size(); ++i) {
+            changedTypes |= m_TouchedSignatures[i] ^ m_Signatures[m_TouchedEntities[i]];
+        }
+        CollectSystems(changedTypes);
         
-        for (auto const& pair : m_Systems) {
-            auto const& system = pair.second;
+        // one pass over the touched entities per candidate system, so each system gets its
+        // whole flush as one removed span and one added span
+        for (System* system : m_CandidateSystems) {
             const Signature& systemSignature = system->GetSignature();
+            m_EnteredBatch.clear();
+            m_LeftBatch.clear();
             
-            if (SignatureMatches(entitySignature, systemSignature)) {
-                system->AddEntity(entity);
-            } else {
-                system->RemoveEntity(entity);
+            for (size_t i = 0; i < m_TouchedEntities.size(); ++i) {
+                const Signature& oldSignature = m_TouchedSignatures[i];
+                const Signature& newSignature = m_Signatures[m_TouchedEntities[i]];
+                if (((oldSignature ^ newSignature) & systemSignature).none()) {
+                    continue;
+                }
+                
+                bool wasMember = SystemMatches(oldSignature, systemSignature);
+                bool isMember = SystemMatches(newSignature, systemSignature);
+                if (isMember && !wasMember) {
+                    m_EnteredBatch.push_back(GetEntity(m_TouchedEntities[i]));
+                } else if (wasMember && !isMember) {
+                    m_LeftBatch.push_back(GetEntity(m_TouchedEntities[i]));
+                }
+            }
+            
+            if (!m_LeftBatch.empty()) {
+                system->RemoveEntities(m_LeftBatch);
+            }
+            if (!m_EnteredBatch.empty()) {
+                system->AddEntities(m_EnteredBatch);
             }
         }
     }
     
-    bool World::SignatureMatches(const Signature& entitySignature, const Signature& systemSignature) const {
-        for (ComponentTypeID componentType : systemSignature) {
-            if (entitySignature.find(componentType) == entitySignature.end()) {
-                return false;
+    void World::NotifyTouchedObservers() {
+        if (m_ConstructObserved.none() && m_DestroyObserved.none()) {
+            return;
+        }
+        
+        Signature constructed;
+        Signature destroyed;
+        for (size_t i = 0; i < m_TouchedEntities.size(); ++i) {
+            const Signature& oldSignature = m_TouchedSignatures[i];
+            const Signature& newSignature = m_Signatures[m_TouchedEntities[i]];
+            constructed |= newSignature & ~oldSignature;
+            destroyed |= oldSignature & ~newSignature;
+        }
+        constructed &= m_ConstructObserved;
+        destroyed &= m_DestroyObserved;
+        if (constructed.none() && destroyed.none()) {
+            return;
+        }
+        
+        // copied out so observers are free to flush or destroy entities themselves
+        std::vector<Entity> entities;
+        std::vector<Signature> constructedChanges;
+        std::vector<Signature> destroyedChanges;
+        for (size_t i = 0; i < m_TouchedEntities.size(); ++i) {
+            const Signature& oldSignature = m_TouchedSignatures[i];
+            const Signature& newSignature = m_Signatures[m_TouchedEntities[i]];
+            entities.push_back(GetEntity(m_TouchedEntities[i]));
+            constructedChanges.push_back(newSignature & ~oldSignature & constructed);
+            destroyedChanges.push_back(oldSignature & ~newSignature & destroyed);
+        }
+        
+        if (destroyed.any()) {
+            NotifyObservers(m_DestroyObservers, destroyed, entities, destroyedChanges);
+        }
+        if (constructed.any()) {
+            NotifyObservers(m_ConstructObservers, constructed, entities, constructedChanges);
+        }
+    }
+    
+    void World::NotifyObservers(ObserverTable& observers, const Signature& types,
+                                Span<const Entity> entities, const std::vector<Signature>& changes) {
+        std::vector<Entity> batch;
+        for (size_t typeID = 0; typeID < MAX_COMPONENTS; ++typeID) {
+            if (!types.test(typeID)) {
+                continue;
+            }
+            
+            batch.clear();
+            for (size_t i = 0; i < entities.size(); ++i) {
+                if (changes[i].test(typeID)) {
+                    batch.push_back(entities[i]);
+                }
+            }
+            CallObservers(observers, static_cast<ComponentTypeID>(typeID), batch);
+        }
+    }
+    
+    void World::CallObservers(ObserverTable& observers, ComponentTypeID typeID, Span<const Entity> entities) {
+        // by index: an observer may register further observers
+        for (size_t i = 0; i < observers[typeID].size(); ++i) {
+            observers[typeID][i](entities);
+        }
+    }
+    
+    void World::CollectSystems(const Signature& types) {
+        m_CandidateSystems.clear();
+        if (types.none()) {
+            return;
+        }
+        
+        for (size_t typeID = 0; typeID < MAX_COMPONENTS; ++typeID) {
+            if (!types.test(typeID)) {
+                continue;
+            }
+            for (System* system : m_ComponentSystems[typeID]) {
+                if (std::find(m_CandidateSystems.begin(), m_CandidateSystems.end(), system) == m_CandidateSystems.end()) {
+                    m_CandidateSystems.push_back(system);
+                }
+            }
+        }
+    }
+    
+    void World::IndexSystem(System* system, const Signature& oldSignature, const Signature& newSignature) {
+        for (size_t typeID = 0; typeID < MAX_COMPONENTS; ++typeID) {
+            auto& systems = m_ComponentSystems[typeID];
+            if (oldSignature.test(typeID)) {
+                systems.erase(std::remove(systems.begin(), systems.end(), system), systems.end());
+            }
+            if (newSignature.test(typeID)) {
+                systems.push_back(system);
             }
         }
-        return true;
     }
     
 }
@@ -3,35 +3,42 @@
 #include <memory>
 #include <unordered_map>
 #include <vector>
+#include <array>
 #include <set>
-#include <queue>
 #include <algorithm>
+#include <deque>
 #include <typeinfo>
 #include <stdexcept>
+#include <atomic>
 #include <functional>
+#include <iosfwd>
 #include "Entity.h"
 #include "Component.h"
 #include "System.h"
+#include "Signature.h"
+#include "Span.h"
+#include "Archetype.h"
+#include "CommandBuffer.h"
+#include "View.h"
+#include "Group.h"
+#include "Prefab.h"
+#include "Rollback.h"
+#include "Resource.h"
+#include "../Jobs/JobSystem.h"
 
 namespace UniversalEngine {
     
-    using Signature = std::set<ComponentTypeID>;
-    
-    enum class PendingOperationType {
-        ADD_COMPONENT,
-        REMOVE_COMPONENT
+    enum class ComponentStorage {
+        SparseSet,  // one ComponentArray per type
+        Archetype   // entities grouped by component set in chunked SoA columns
     };
     
-    struct PendingOperation {
-        PendingOperationType type;
-        Entity entity;
-        ComponentTypeID componentType;
-        std::function<void()> operation;
-    };
+    // receives every entity that gained (OnConstruct) or lost (OnDestroy) a component type
+    using ComponentObserver = std::function<void(Span<const Entity> entities)>;
     
     class World {
     public:
-        World();
+        explicit World(ComponentStorage storage = ComponentStorage::SparseSet);
         ~World();
         
         World(const World&) = delete;
@@ -42,103 +49,182 @@ namespace UniversalEngine {
         
         Entity CreateEntity();
         void DestroyEntity(Entity entity);
-        bool IsEntityValid(Entity entity) const;
+        
+        // creates count entities into out[0, count), reusing free slots before taking fresh
+        // IDs; the reused slots come first in ascending order, the fresh IDs are consecutive
+        void CreateEntities(size_t count, Span<Entity> out);
+        
+        // removes components and system membership once per batch rather than per entity
+        void DestroyEntities(Span<const Entity> entities);
+        
+        // creates count entities into out[0, count) carrying copies of the prefab's components;
+        // applied immediately, one column copy per component type
+        void Instantiate(const Prefab& prefab, size_t count, Span<Entity> out);
+        Entity Instantiate(const Prefab& prefab);
+        
+        // Thread-safe. The handle takes a fresh ID (free slots are not reused) and can be
+        // given components right away; it becomes a live entity at the next ecs_flush().
+        // This is the only way to make entities while systems run in parallel: CreateEntity(),
+        // CreateEntities(), DestroyEntities() and ecs_flush() resize or rewrite the generation
+        // table that jobs read through IsEntityValid(), so they throw during a parallel stage
+        // and must not be called from the main thread while other jobs are in flight.
+        // IDs are handed out in the order reservations actually run: commands queued for them
+        // apply in a fixed order, but jobs running in parallel can get different IDs from one
+        // run to the next. Replays that compare entity IDs should reserve outside parallel work.
+        Entity ReserveEntity() {
+            return Entity(m_NextEntityID.fetch_add(1, std::memory_order_relaxed), 1);
+        }
+        
+        // generations are odd while a slot is alive and even once it has been destroyed
+        bool IsEntityValid(Entity entity) const {
+            EntityID entityID = entity.GetID();
+            return entityID < m_Generations.size() && (entity.GetGeneration() & 1) != 0 &&
+                   m_Generations[entityID] == entity.GetGeneration();
+        }
+        
+        // current handle for a slot, or an invalid Entity if the slot is not alive
+        Entity GetEntity(EntityID entityID) const {
+            if (entityID == INVALID_ENTITY || entityID >= m_Generations.size() || (m_Generations[entityID] & 1) == 0) {
+                return Entity();
+            }
+            return Entity(entityID, m_Generations[entityID]);
+        }
         
         template<typename T>
         void RegisterComponent() {
-            static_assert(std::is_base_of_v<Component, T>, "T must inherit from Component");
-            
-            ComponentTypeID typeID = ComponentTypeRegistry::GetTypeID<T>();
+            static_assert(IsComponent_v<T>, "T must inherit from Component or be an opted-in POD component");
             
-            if (m_ComponentArrays.find(typeID) != m_ComponentArrays.end()) {
-                return;
-            }
-            
-            m_ComponentArrays[typeID] = std::make_unique<ComponentArray<T>>();
+            RegisterComponentType(ComponentTypeInfo::Of<T>());
         }
         
         template<typename T>
         void AddComponent(Entity entity, T component) {
-            static_assert(std::is_base_of_v<Component, T>, "T must inherit from Component");
+            static_assert(IsComponent_v<T>, "T must inherit from Component or be an opted-in POD component");
             
-            if (!IsEntityValid(entity)) {
+            if (!IsEntityValid(entity) && !IsEntityReserved(entity)) {
                 throw std::runtime_error("Entity is not valid");
             }
             
-            ComponentTypeID typeID = ComponentTypeRegistry::GetTypeID<T>();
+            // the type is registered when the command is applied, so any thread can queue it
+            GetThreadCommandBuffer().AddComponent(entity, std::move(component), JobSystem::NextSubmissionOrder());
+        }
+        
+        // queues a copy of component for each entity; systems see the whole batch at one flush
+        template<typename T>
+        void AddComponents(Span<const Entity> entities, const T& component) {
+            static_assert(IsComponent_v<T>, "T must inherit from Component or be an opted-in POD component");
             
-            if (m_ComponentArrays.find(typeID) == m_ComponentArrays.end()) {
-                RegisterComponent<T>();
+            for (Entity entity : entities) {
+                if (!IsEntityValid(entity) && !IsEntityReserved(entity)) {
+                    throw std::runtime_error("Entity is not valid");
+                }
             }
             
-            PendingOperation op;
-            op.type = PendingOperationType::ADD_COMPONENT;
-            op.entity = entity;
-            op.componentType = typeID;
-            
-            // used shared_ptr to make the lambda copy constructible
-            auto componentPtr = std::make_shared<T>(std::move(component));
-            op.operation = [this, entity, componentPtr, typeID]() {
-                this->GetComponentArray<T>()->InsertData(entity.GetID(), std::move(*componentPtr));
-                m_Signatures[entity.GetID()].insert(typeID);
-                UpdateEntitySystems(entity);
-            };
-            
-            m_PendingOperations.push_back(std::move(op));
+            GetThreadCommandBuffer().AddComponents(entities, component, JobSystem::NextSubmissionOrder(entities.size()));
         }
         
         template<typename T>
         void RemoveComponent(Entity entity) {
-            static_assert(std::is_base_of_v<Component, T>, "T must inherit from Component");
+            static_assert(IsComponent_v<T>, "T must inherit from Component or be an opted-in POD component");
             
-            if (!IsEntityValid(entity)) {
+            if (!IsEntityValid(entity) && !IsEntityReserved(entity)) {
                 return;
             }
             
-            ComponentTypeID typeID = ComponentTypeRegistry::GetTypeID<T>();
+            GetThreadCommandBuffer().RemoveComponent<T>(entity, JobSystem::NextSubmissionOrder());
+        }
+        
+        template<typename T>
+        T& GetComponent(Entity entity) {
+            static_assert(IsComponent_v<T>, "T must inherit from Component or be an opted-in POD component");
             
-            if (m_ComponentArrays.find(typeID) == m_ComponentArrays.end()) {
-                return;
+            if (!IsEntityValid(entity)) {
+                throw std::runtime_error("Entity is not valid");
             }
             
-            PendingOperation op;
-            op.type = PendingOperationType::REMOVE_COMPONENT;
-            op.entity = entity;
-            op.componentType = typeID;
-            op.operation = [this, entity, typeID]() {
-                this->GetComponentArray<T>()->RemoveData(entity.GetID());
-                m_Signatures[entity.GetID()].erase(typeID);
-                UpdateEntitySystems(entity);
-            };
+            if (m_Storage == ComponentStorage::Archetype) {
+                return GetArchetypeComponent<T>(entity);
+            }
             
-            m_PendingOperations.push_back(std::move(op));
+            return GetComponentArray<T>()->GetData(entity.GetID());
         }
         
         template<typename T>
-        T& GetComponent(Entity entity) {
-            static_assert(std::is_base_of_v<Component, T>, "T must inherit from Component");
+        const T& GetComponent(Entity entity) const {
+            static_assert(IsComponent_v<T>, "T must inherit from Component or be an opted-in POD component");
             
             if (!IsEntityValid(entity)) {
                 throw std::runtime_error("Entity is not valid");
             }
             
+            if (m_Storage == ComponentStorage::Archetype) {
+                return GetArchetypeComponent<T>(entity);
+            }
+            
             return GetComponentArray<T>()->GetData(entity.GetID());
         }
         
+        // GetComponent() for writing: also stamps the component as changed at the current
+        // tick. Archetype storage keeps no ticks, so there it is plain GetComponent().
         template<typename T>
-        const T& GetComponent(Entity entity) const {
-            static_assert(std::is_base_of_v<Component, T>, "T must inherit from Component");
+        T& GetMut(Entity entity) {
+            static_assert(IsComponent_v<T>, "T must inherit from Component or be an opted-in POD component");
             
             if (!IsEntityValid(entity)) {
                 throw std::runtime_error("Entity is not valid");
             }
             
-            return GetComponentArray<T>()->GetData(entity.GetID());
+            if (m_Storage == ComponentStorage::Archetype) {
+                return GetArchetypeComponent<T>(entity);
+            }
+            
+            return GetComponentArray<T>()->GetMut(entity.GetID());
+        }
+        
+        // whether the entity's T was added or written mutably after since; always true
+        // under archetype storage, which keeps no ticks
+        template<typename T>
+        bool HasChangedSince(Entity entity, Tick since) {
+            static_assert(IsComponent_v<T>, "T must inherit from Component or be an opted-in POD component");
+            
+            if (m_Storage == ComponentStorage::Archetype) {
+                return true;
+            }
+            
+            ComponentArray<T>* componentArray = FindComponentArray<T>();
+            if (!IsEntityValid(entity) || !componentArray) {
+                return false;
+            }
+            
+            std::uint32_t index = componentArray->GetIndex(entity.GetID());
+            return index != ComponentArray<T>::INVALID_INDEX && IsNewerTick(componentArray->GetChangeTickAt(index), since);
+        }
+        
+        // nullptr instead of an exception when the entity is invalid or lacks the component
+        template<typename T>
+        T* TryGetComponent(Entity entity) {
+            static_assert(IsComponent_v<T>, "T must inherit from Component or be an opted-in POD component");
+            
+            if (!IsEntityValid(entity)) {
+                return nullptr;
+            }
+            
+            if (m_Storage == ComponentStorage::Archetype) {
+                return static_cast<T*>(m_Archetypes->Get(entity.GetID(), ComponentTypeRegistry::GetTypeID<T>()));
+            }
+            
+            ComponentArray<T>* componentArray = FindComponentArray<T>();
+            if (!componentArray) {
+                return nullptr;
+            }
+            
+            std::uint32_t index = componentArray->GetIndex(entity.GetID());
+            return index != ComponentArray<T>::INVALID_INDEX ? &componentArray->GetDataAt(index) : nullptr;
         }
         
         template<typename T>
         bool HasComponent(Entity entity) const {
-            static_assert(std::is_base_of_v<Component, T>, "T must inherit from Component");
+            static_assert(IsComponent_v<T>, "T must inherit from Component or be an opted-in POD component");
             
             if (!IsEntityValid(entity)) {
                 return false;
@@ -146,10 +232,14 @@ namespace UniversalEngine {
             
             ComponentTypeID typeID = ComponentTypeRegistry::GetTypeID<T>();
             
-            if (m_ComponentArrays.find(typeID) == m_ComponentArrays.end()) {
+            if (!IsComponentRegistered(typeID)) {
                 return false;
             }
             
+            if (m_Storage == ComponentStorage::Archetype) {
+                return m_Archetypes->Has(entity.GetID(), typeID);
+            }
+            
             return GetComponentArray<T>()->HasData(entity.GetID());
         }
         
@@ -186,20 +276,73 @@ namespace UniversalEngine {
                 throw std::runtime_error("System not registered");
             }
             
-            m_Systems[typeID]->SetSignature(signature);
+            System* system = m_Systems[typeID].get();
+            IndexSystem(system, system->GetSignature(), signature);
+            system->SetSignature(signature);
             
-            for (const auto& pair : m_Signatures) {
-                EntityID entityID = pair.first;
-                const Signature& entitySignature = pair.second;
-                
-                Entity entity(entityID);
+            m_EnteredBatch.clear();
+            m_LeftBatch.clear();
+            for (EntityID entityID = 1; entityID < m_Signatures.size(); ++entityID) {
+                Entity entity = GetEntity(entityID);
+                bool matches = entity.IsValid() && SystemMatches(m_Signatures[entityID], signature);
                 
-                if (SignatureMatches(entitySignature, signature)) {
-                    m_Systems[typeID]->AddEntity(entity);
-                } else {
-                    m_Systems[typeID]->RemoveEntity(entity);
+                if (matches && !system->HasEntity(entity)) {
+                    m_EnteredBatch.push_back(entity);
+                } else if (!matches && system->HasEntity(entity)) {
+                    m_LeftBatch.push_back(entity);
                 }
             }
+            
+            if (!m_LeftBatch.empty()) {
+                system->RemoveEntities(m_LeftBatch);
+            }
+            if (!m_EnteredBatch.empty()) {
+                system->AddEntities(m_EnteredBatch);
+            }
+        }
+        
+        // Component observers, called once per ecs_flush() (and per Instantiate or
+        // DestroyEntities call) with every entity whose T appeared or disappeared in it.
+        // They run after the change: OnDestroy entities no longer have T, and entities that
+        // were destroyed outright are no longer valid. Replacing an existing T fires neither.
+        template<typename T>
+        void OnConstruct(ComponentObserver observer) {
+            RegisterComponent<T>();
+            
+            ComponentTypeID typeID = ComponentTypeRegistry::GetTypeID<T>();
+            m_ConstructObservers[typeID].push_back(std::move(observer));
+            m_ConstructObserved.set(typeID);
+        }
+        
+        template<typename T>
+        void OnDestroy(ComponentObserver observer) {
+            RegisterComponent<T>();
+            
+            ComponentTypeID typeID = ComponentTypeRegistry::GetTypeID<T>();
+            m_DestroyObservers[typeID].push_back(std::move(observer));
+            m_DestroyObserved.set(typeID);
+        }
+        
+        // orders a system's entities by their dense index in TComponent's array, so walking
+        // GetEntities() touches that array front to back
+        template<typename TSystem, typename TComponent>
+        void SortSystemEntities() {
+            std::shared_ptr<TSystem> system = GetSystem<TSystem>();
+            if (!system) {
+                throw std::runtime_error("System not registered");
+            }
+            if (m_Storage != ComponentStorage::SparseSet) {
+                throw std::runtime_error("SortSystemEntities requires sparse-set component storage");
+            }
+            
+            ComponentArray<TComponent>* componentArray = FindComponentArray<TComponent>();
+            if (!componentArray) {
+                return;
+            }
+            
+            system->SortEntities([componentArray](Entity a, Entity b) {
+                return componentArray->GetIndex(a.GetID()) < componentArray->GetIndex(b.GetID());
+            });
         }
         
         template<typename T>
@@ -215,27 +358,348 @@ namespace UniversalEngine {
             return std::static_pointer_cast<T>(m_Systems[typeID]);
         }
         
+        // sparse-set storage only: iterates every entity that has all of Ts,
+        // e.g. for (auto [entity, transform, body] : world.View<Transform2D, const Rigidbody2D>())
+        template<typename... Ts>
+        ComponentView<Ts...> View() {
+            static_assert((IsComponent_v<std::remove_const_t<Ts>> && ...), "Ts must be component types");
+            
+            if (m_Storage != ComponentStorage::SparseSet) {
+                throw std::runtime_error("View requires sparse-set component storage");
+            }
+            
+            return ComponentView<Ts...>(&m_Generations, FindComponentArray<std::remove_const_t<Ts>>()...);
+        }
+        
+        // sparse-set storage only: keeps the ComponentArrays of Ts partitioned so the first
+        // Size() entries of each refer to the same entities in the same order. A component
+        // type can be owned by one group at a time; Group<const T> and Group<T> own the same
+        // arrays, the const form only hands T out read-only and leaves its ticks alone.
+        template<typename... Ts>
+        OwningGroup<Ts...> Group() {
+            static_assert(sizeof...(Ts) > 0, "A group must own at least one component type");
+            static_assert((IsComponent_v<std::remove_const_t<Ts>> && ...), "Ts must be component types");
+            
+            if (m_Storage != ComponentStorage::SparseSet) {
+                throw std::runtime_error("Group requires sparse-set component storage");
+            }
+            
+            (RegisterComponent<std::remove_const_t<Ts>>(), ...);
+            
+            Signature owned;
+            (owned.set(ComponentTypeRegistry::GetTypeID<std::remove_const_t<Ts>>()), ...);
+            
+            GroupData* group = FindGroup(owned);
+            if (!group) {
+                group = CreateGroup(owned, { GetComponentArray<std::remove_const_t<Ts>>()... });
+            }
+            
+            return OwningGroup<Ts...>(group, &m_Generations, GetComponentArray<std::remove_const_t<Ts>>()...);
+        }
+        
+        // Sparse-set storage only. Reorders T's array with cmp(const T&, const T&); a type
+        // owned by a group keeps the group's order and cannot be sorted.
+        template<typename T, typename Compare>
+        void Sort(Compare cmp) {
+            static_assert(IsComponent_v<T>, "T must inherit from Component or be an opted-in POD component");
+            
+            ThrowIfNotReorderable(ComponentTypeRegistry::GetTypeID<T>(), "Sort");
+            if (ComponentArray<T>* componentArray = FindComponentArray<T>()) {
+                componentArray->Sort(cmp);
+            }
+        }
+        
+        // Sparse-set storage only. Moves the entities each of Others shares with Primary to
+        // the front of that array, in Primary's order, so a join driven by Primary walks
+        // every array forwards. Swap-removal undoes this over time; see EnableDefragmentation.
+        template<typename Primary, typename... Others>
+        void AlignTo() {
+            static_assert(sizeof...(Others) > 0, "AlignTo needs at least one array to reorder");
+            
+            AlignmentPass pass = MakeAlignmentPass<Primary, Others...>();
+            AdvanceAlignment(pass, ~size_t(0));
+        }
+        
+        // keeps running AlignTo<Primary, Others...>() in the background: each Update() spends
+        // up to the defragmentation budget of Primary entities before the systems run
+        template<typename Primary, typename... Others>
+        void EnableDefragmentation() {
+            static_assert(sizeof...(Others) > 0, "AlignTo needs at least one array to reorder");
+            
+            m_AlignmentPasses.push_back(MakeAlignmentPass<Primary, Others...>());
+        }
+        
+        // Primary entities visited per Update() across all defragmentation passes; 0 disables
+        void SetDefragmentationBudget(size_t entitiesPerUpdate) { m_DefragmentationBudget = entitiesPerUpdate; }
+        size_t GetDefragmentationBudget() const { return m_DefragmentationBudget; }
+        
+        // archetype storage only: fn(count, entities, Ts*...) once per chunk holding all of Ts
+        template<typename... Ts, typename Func>
+        void ForEachChunk(Func&& fn) {
+            if (m_Storage != ComponentStorage::Archetype) {
+                throw std::runtime_error("ForEachChunk requires archetype component storage");
+            }
+            
+            Signature required;
+            (required.set(ComponentTypeRegistry::GetTypeID<Ts>()), ...);
+            
+            m_Archetypes->ForEachChunk(required, [&](Archetype& archetype, size_t chunk) {
+                fn(archetype.GetChunkSize(chunk), archetype.GetEntities(chunk),
+                   static_cast<Ts*>(archetype.GetColumn(chunk, ComponentTypeRegistry::GetTypeID<Ts>()))...);
+            });
+        }
+        
+        // Sparse-set storage only: T's array, or nullptr while T is unregistered. For systems
+        // that walk their own entity order and want dense-index access without a per-entity
+        // validity check; indices hold until the next flush, destruction, Sort or AlignTo.
+        template<typename T>
+        ComponentArray<T>* FindComponentArray() {
+            auto it = m_ComponentArrays.find(ComponentTypeRegistry::GetTypeID<T>());
+            return it != m_ComponentArrays.end() ? static_cast<ComponentArray<T>*>(it->second.get()) : nullptr;
+        }
+        
+        // Sparse-set storage only. Writes a versioned binary snapshot: the entity table, then
+        // every trivially copyable component type as a raw dense column plus its entity IDs.
+        // Other component types are not written. Columns are keyed by ComponentTypeInfo's
+        // name hash, so a snapshot only loads into a build from the same compiler.
+        void SaveSnapshot(std::ostream& stream);
+        
+        // Replaces every entity and component with the snapshot's. Its component types must be
+        // registered; components of types it does not carry are dropped. Loaded components
+        // are stamped at the current tick and systems and groups are refilled, but observers
+        // are not called; recorded rollback history is dropped. A corrupt entity or column
+        // table is rejected before the World is touched; component data that turns out to be
+        // corrupt partway leaves the World empty.
+        void LoadSnapshot(std::istream& stream);
+        
+        // Sparse-set storage only. Keeps the last frameCount states recorded by RecordFrame()
+        // for the entity table and Ts, which must be trivially copyable. Each recorded frame
+        // stores only what changed since the previous one. Adding types clears the history.
+        template<typename... Ts>
+        void EnableRollback(size_t frameCount) {
+            static_assert(sizeof...(Ts) > 0, "EnableRollback needs at least one component type");
+            static_assert((IsComponent_v<Ts> && ...), "Ts must be component types");
+            static_assert((std::is_trivially_copyable_v<Ts> && ...), "Rollback components must be trivially copyable");
+            
+            if (m_Storage != ComponentStorage::SparseSet) {
+                throw std::runtime_error("EnableRollback requires sparse-set component storage");
+            }
+            if (frameCount == 0) {
+                throw std::runtime_error("EnableRollback needs at least one frame");
+            }
+            
+            (RegisterComponent<Ts>(), ...);
+            (AddRollbackColumn<Ts>(), ...);
+            
+            m_RollbackFrames.clear();
+            m_RollbackFrames.resize(frameCount);
+            m_RollbackHead = 0;
+            m_RollbackCount = 0;
+        }
+        
+        // Records the current state as the newest frame, dropping the oldest once the ring is
+        // full. Call it once per simulation step, after ecs_flush().
+        void RecordFrame();
+        
+        // Restores the state recorded frames steps before the newest one and forgets the frames
+        // after it; Rewind(0) discards whatever changed since the last RecordFrame(). Entities
+        // that did not exist then are destroyed, and ones destroyed since come back with only
+        // their rollback components. To re-simulate, run Update() and RecordFrame() again
+        // from the restored state.
+        void Rewind(size_t frames);
+        
+        // states Rewind() can reach, the newest included
+        size_t GetRecordedFrameCount() const { return m_RollbackCount; }
+        
+        // Resources are world-wide singletons (settings, a camera, ...) looked up by type in a
+        // flat array instead of living on an entity. Each one is heap allocated, so references
+        // stay valid until it is replaced or removed. Safe to read from parallel systems, not
+        // to set or remove while systems run. Snapshots and rollback leave them alone.
+        template<typename T>
+        T& SetResource(T resource) {
+            ResourceTypeID typeID = ResourceTypeRegistry::GetTypeID<T>();
+            if (typeID >= m_Resources.size()) {
+                m_Resources.resize(typeID + 1);
+            }
+            
+            if (m_Resources[typeID]) {
+                T& existing = *static_cast<T*>(m_Resources[typeID].get());
+                existing = std::move(resource);
+                return existing;
+            }
+            
+            m_Resources[typeID] = std::make_shared<T>(std::move(resource));
+            return *static_cast<T*>(m_Resources[typeID].get());
+        }
+        
+        template<typename T>
+        T& GetResource() {
+            T* resource = TryGetResource<T>();
+            if (!resource) {
+                throw std::runtime_error("Resource not set");
+            }
+            return *resource;
+        }
+        
+        template<typename T>
+        const T& GetResource() const {
+            const T* resource = TryGetResource<T>();
+            if (!resource) {
+                throw std::runtime_error("Resource not set");
+            }
+            return *resource;
+        }
+        
+        template<typename T>
+        T* TryGetResource() {
+            ResourceTypeID typeID = ResourceTypeRegistry::GetTypeID<T>();
+            return typeID < m_Resources.size() ? static_cast<T*>(m_Resources[typeID].get()) : nullptr;
+        }
+        
+        template<typename T>
+        const T* TryGetResource() const {
+            ResourceTypeID typeID = ResourceTypeRegistry::GetTypeID<T>();
+            return typeID < m_Resources.size() ? static_cast<const T*>(m_Resources[typeID].get()) : nullptr;
+        }
+        
+        template<typename T>
+        bool HasResource() const {
+            return TryGetResource<T>() != nullptr;
+        }
+        
+        template<typename T>
+        void RemoveResource() {
+            ResourceTypeID typeID = ResourceTypeRegistry::GetTypeID<T>();
+            if (typeID < m_Resources.size()) {
+                m_Resources[typeID].reset();
+            }
+        }
+        
+        ComponentStorage GetComponentStorage() const { return m_Storage; }
+        
+        // Applies every queued command. Commands apply in SubmissionOrder, the order a serial
+        // run would have queued them in (see JobKey), so the result does not depend on which
+        // worker ran which job: component types in the order of their first command, and each
+        // type's commands in order. Only work nested deeper than JobKey::MAX_DEPTH loses this.
         void ecs_flush();
         void Update(float deltaTime);
+        
+        // one fixed simulation step: runs every enabled system's FixedUpdate() on the same
+        // schedule as Update() and closes a tick after each stage, so sub-steps of one frame
+        // stamp distinct ticks. Last-run ticks are left alone; they belong to Update().
+        // Commands are not flushed; call ecs_flush() between steps
+        void FixedUpdate(float fixedDeltaTime);
+        
         void Render();
         void Shutdown();
         
+        // not owned; Update() runs non-conflicting systems on it and systems can use it for
+        // their own parallel work. Without one everything runs on the calling thread.
+        // also sizes the per-thread command buffers, so call it while no commands are pending
+        void SetJobSystem(JobSystem* jobSystem);
+        JobSystem* GetJobSystem() const { return m_JobSystem; }
+        
+        // Writes are stamped with GetTick(). Update() and FixedUpdate() close the tick after
+        // each stage, and Update() records it as the stage's systems' last-run tick; anything
+        // else that wants to consume changes (a renderer, say) closes its own with
+        // AdvanceTick(), which returns the closed tick: later writes compare newer than it.
+        Tick GetTick() const { return m_Tick; }
+        Tick AdvanceTick() { return m_Tick++; }
+        
+        // number of sequential stages in the current system schedule
+        size_t GetScheduleStageCount();
+        
         size_t GetEntityCount() const { return m_LivingEntityCount; }
         size_t GetSystemCount() const { return m_Systems.size(); }
-        size_t GetPendingOperationCount() const { return m_PendingOperations.size(); }
-        
+        size_t GetPendingOperationCount() const;
+    
     private:
-        std::queue<EntityID> m_AvailableEntities;
-        std::unordered_map<EntityID, Signature> m_Signatures;
-        EntityID m_NextEntityID;
+        std::vector<EntityID> m_FreeEntities;
+        std::vector<EntityGeneration> m_Generations;
+        std::vector<Signature> m_Signatures;
         size_t m_LivingEntityCount;
+        std::atomic<EntityID> m_NextEntityID{ 1 };
         
+        // set while RunStage() has systems on workers; CreateEntity() and friends would grow
+        // m_Generations under jobs reading it, so they throw instead
+        std::atomic<bool> m_ParallelStageRunning{ false };
+        Tick m_Tick = 1;
+        
+        ComponentStorage m_Storage;
         std::unordered_map<ComponentTypeID, std::unique_ptr<IComponentArray>> m_ComponentArrays;
+        std::unique_ptr<ArchetypeStorage> m_Archetypes;
+        
+        // one per JobSystem thread index, so queuing needs no lock; ecs_flush() merges them
+        // by SubmissionOrder, as the thread a job ran on says nothing about its place
+        std::vector<CommandBuffer> m_CommandBuffers;
+        
+        // ecs_flush() scratch: one entry per component type with queued commands, pointing at
+        // its one thread queue when that is already in order, else at a merged copy
+        struct PendingCommands {
+            const ComponentTypeInfo* typeInfo;
+            const std::vector<ComponentCommand>* commands;
+            size_t addCount;
+            size_t merged;
+        };
+        
+        std::vector<PendingCommands> m_PendingCommands;
+        std::deque<std::vector<ComponentCommand>> m_MergedCommands;  // deque: growing keeps pointers
+        std::vector<EntityID> m_TouchedEntities;
+        std::vector<Signature> m_TouchedSignatures;
+        std::vector<std::uint32_t> m_TouchedFlushID;
+        std::uint32_t m_FlushID = 0;
+        
+        std::vector<std::unique_ptr<GroupData>> m_Groups;
+        std::array<GroupData*, MAX_COMPONENTS> m_GroupOwners{};
         
         std::unordered_map<SystemTypeID, std::shared_ptr<System>> m_Systems;
         std::vector<std::shared_ptr<System>> m_SystemsVector;
         
-        std::vector<PendingOperation> m_PendingOperations;
+        // systems within a stage have no conflicting component access
+        std::vector<std::vector<System*>> m_Stages;
+        std::vector<std::uint32_t> m_ScheduledVersions;
+        JobSystem* m_JobSystem = nullptr;
+        
+        // indexed by ResourceTypeID; shared_ptr<void> keeps each type's deleter
+        std::vector<std::shared_ptr<void>> m_Resources;
+        
+        // reverse index: the systems whose signature references each component type
+        std::array<std::vector<System*>, MAX_COMPONENTS> m_ComponentSystems;
+        std::vector<System*> m_CandidateSystems;
+        std::vector<Entity> m_DestroyBatch;
+        std::vector<EntityID> m_InstantiateBatch;
+        std::vector<Entity> m_EnteredBatch;
+        std::vector<Entity> m_LeftBatch;
+        
+        // AlignTo() state: cursor walks Primary's dense array; next[k] is the first slot of
+        // others[k] not yet in Primary's order
+        struct AlignmentPass {
+            ComponentTypeID primary = 0;
+            std::vector<ComponentTypeID> others;
+            std::vector<size_t> next;
+            size_t cursor = 0;
+        };
+        
+        std::vector<AlignmentPass> m_AlignmentPasses;
+        size_t m_DefragmentationBudget = 0;
+        
+        // rollback ring; m_RollbackHead is the newest recorded frame
+        std::vector<std::unique_ptr<IRollbackColumn>> m_RollbackColumns;
+        std::vector<RollbackFrame> m_RollbackFrames;
+        size_t m_RollbackHead = 0;
+        size_t m_RollbackCount = 0;
+        
+        // entity table as of the newest recorded frame
+        std::vector<EntityGeneration> m_RollbackGenerations;
+        std::vector<EntityID> m_RollbackFreeEntities;
+        size_t m_RollbackLivingCount = 0;
+        
+        using ObserverTable = std::array<std::vector<ComponentObserver>, MAX_COMPONENTS>;
+        
+        ObserverTable m_ConstructObservers;
+        ObserverTable m_DestroyObservers;
+        Signature m_ConstructObserved;
+        Signature m_DestroyObserved;
         
         template<typename T>
         ComponentArray<T>* GetComponentArray() {
@@ -259,8 +723,127 @@ namespace UniversalEngine {
             return static_cast<const ComponentArray<T>*>(m_ComponentArrays.at(typeID).get());
         }
         
-        void UpdateEntitySystems(Entity entity);
-        bool SignatureMatches(const Signature& entitySignature, const Signature& systemSignature) const;
+        // a thread outside the World's JobSystem would share another thread's buffer unsynchronized
+        CommandBuffer& GetThreadCommandBuffer() {
+            size_t threadIndex = m_JobSystem ? m_JobSystem->GetThreadIndex() : 0;
+            if (threadIndex >= m_CommandBuffers.size()) {
+                throw std::runtime_error("Commands must be queued from the main thread or a World job system worker");
+            }
+            return m_CommandBuffers[threadIndex];
+        }
+        
+        // reserved by ReserveEntity() and not yet materialized by a flush
+        bool IsEntityReserved(Entity entity) const {
+            EntityID entityID = entity.GetID();
+            return entityID >= m_Generations.size() && entity.GetGeneration() == 1 &&
+                   entityID < m_NextEntityID.load(std::memory_order_relaxed);
+        }
+        
+        void MaterializeReservedEntities();
+        
+        // makes every slot below end a live entity with generation 1
+        void MaterializeEntitiesBelow(EntityID end);
+        
+        void ThrowIfStageRunning(const char* operation) const;
+        void ClearForLoad();
+        void ReadSnapshotColumns(std::istream& stream, const std::vector<IComponentArray*>& columns,
+                                 const std::vector<std::uint32_t>& counts);
+        void RegisterComponentType(const ComponentTypeInfo& typeInfo);
+        
+        bool IsComponentRegistered(ComponentTypeID typeID) const {
+            if (m_Storage == ComponentStorage::Archetype) {
+                return typeID < MAX_COMPONENTS && m_Archetypes->IsRegistered(typeID);
+            }
+            return m_ComponentArrays.find(typeID) != m_ComponentArrays.end();
+        }
+        
+        template<typename T>
+        T& GetArchetypeComponent(Entity entity) const {
+            void* component = m_Archetypes->Get(entity.GetID(), ComponentTypeRegistry::GetTypeID<T>());
+            if (!component) {
+                throw std::runtime_error("Entity does not have this component");
+            }
+            return *static_cast<T*>(component);
+        }
+        
+        void CollectPendingCommands();
+        void ApplyCommands(const PendingCommands& pending);
+        
+        template<typename Primary, typename... Others>
+        AlignmentPass MakeAlignmentPass() {
+            static_assert(IsComponent_v<Primary> && (IsComponent_v<Others> && ...), "AlignTo needs component types");
+            
+            RegisterComponent<Primary>();
+            (RegisterComponent<Others>(), ...);
+            (ThrowIfNotReorderable(ComponentTypeRegistry::GetTypeID<Others>(), "AlignTo"), ...);
+            
+            AlignmentPass pass;
+            pass.primary = ComponentTypeRegistry::GetTypeID<Primary>();
+            pass.others = { ComponentTypeRegistry::GetTypeID<Others>()... };
+            pass.next.assign(pass.others.size(), 0);
+            return pass;
+        }
+        
+        void ThrowIfNotReorderable(ComponentTypeID typeID, const char* operation) const;
+        
+        template<typename T>
+        void AddRollbackColumn() {
+            ComponentTypeID typeID = ComponentTypeRegistry::GetTypeID<T>();
+            for (const auto& column : m_RollbackColumns) {
+                if (column->GetTypeID() == typeID) {
+                    return;
+                }
+            }
+            m_RollbackColumns.push_back(std::make_unique<RollbackColumn<T>>(FindComponentArray<T>()));
+        }
+        
+        void UndoRollbackFrame(RollbackFrame& frame);
+        void ApplyRollbackState();
+        
+        // visits at most budget Primary entities; returns how many it visited, stopping early
+        // (and rewinding for the next pass) when it reaches the end of Primary
+        size_t AdvanceAlignment(AlignmentPass& pass, size_t budget);
+        void Defragment();
+        
+        GroupData* FindGroup(const Signature& owned);
+        GroupData* CreateGroup(const Signature& owned, std::vector<IComponentArray*> arrays);
+        void UpdateGroups(EntityID entityID);
+        
+        void TouchEntity(EntityID entityID) {
+            if (entityID >= m_TouchedFlushID.size()) {
+                m_TouchedFlushID.resize(m_Generations.size(), 0);
+            }
+            if (m_TouchedFlushID[entityID] != m_FlushID) {
+                m_TouchedFlushID[entityID] = m_FlushID;
+                m_TouchedEntities.push_back(entityID);
+                m_TouchedSignatures.push_back(m_Signatures[entityID]);
+            }
+        }
+        
+        bool IsScheduleStale() const;
+        void BuildSchedule();
+        using SystemStep = void (System::*)(float);
+        void RunStage(const std::vector<System*>& stage, SystemStep step, float deltaTime);
+        
+        void UpdateTouchedSystems();
+        void NotifyTouchedObservers();
+        
+        // changes[i] holds the observed types entities[i] gained or lost
+        void NotifyObservers(ObserverTable& observers, const Signature& types,
+                             Span<const Entity> entities, const std::vector<Signature>& changes);
+        void CallObservers(ObserverTable& observers, ComponentTypeID typeID, Span<const Entity> entities);
+        
+        void CollectSystems(const Signature& types);
+        void IndexSystem(System* system, const Signature& oldSignature, const Signature& newSignature);
+        
+        bool SignatureMatches(const Signature& entitySignature, const Signature& systemSignature) const {
+            return (entitySignature & systemSignature) == systemSignature;
+        }
+        
+        // a system with an empty signature tracks no entities
+        bool SystemMatches(const Signature& entitySignature, const Signature& systemSignature) const {
+            return systemSignature.any() && SignatureMatches(entitySignature, systemSignature);
+        }
     };
-    
+
 }
@@ -45,7 +45,10 @@ namespace UniversalEngine {
         
         Renderer::Init();
         
+        m_JobSystem = std::make_unique<JobSystem>();
+        
         m_World = std::make_unique<World>();
+        m_World->SetJobSystem(m_JobSystem.get());
         SetupScene();
 
         IMGUI_CHECKVERSION();
@@ -67,6 +70,7 @@ namespace UniversalEngine {
         }
         
         m_World.reset();
+        m_JobSystem.reset();
         
         Renderer::Shutdown();
         
@@ -97,11 +101,8 @@ namespace UniversalEngine {
     }
     
     void Engine::SetupScene() {
-        m_World->RegisterComponent<Scene>();
-        
-        m_SceneEntity = m_World->CreateEntity();
-        Scene sceneComponent(1.0f);
-        m_World->AddComponent(m_SceneEntity, std::move(sceneComponent));
+        m_World->SetResource(Scene(1.0f));
+        m_World->SetResource(Physics2DSettings());
         
         SimpleScene2D::CreateScene(*m_World);
         
@@ -109,16 +110,16 @@ namespace UniversalEngine {
         m_RenderSystem->SetViewportSize(m_WindowWidth, m_WindowHeight);
         
         Signature renderSignature;
-        renderSignature.insert(ComponentTypeRegistry::GetTypeID<Transform2D>());
-        renderSignature.insert(ComponentTypeRegistry::GetTypeID<MeshRenderer2D>());
+        renderSignature.set(ComponentTypeRegistry::GetTypeID<Transform2D>());
+        renderSignature.set(ComponentTypeRegistry::GetTypeID<MeshRenderer2D>());
         m_World->SetSystemSignature<RenderSystem2D>(renderSignature);
         
         m_PhysicsSystem = m_World->RegisterSystem<Physics2DSystem>();
         m_PhysicsSystem->SetWorld(m_World.get());
         
         Signature physicsSignature;
-        physicsSignature.insert(ComponentTypeRegistry::GetTypeID<Transform2D>());
-        physicsSignature.insert(ComponentTypeRegistry::GetTypeID<BoxCollider2D>());
+        physicsSignature.set(ComponentTypeRegistry::GetTypeID<Transform2D>());
+        physicsSignature.set(ComponentTypeRegistry::GetTypeID<BoxCollider2D>());
         m_World->SetSystemSignature<Physics2DSystem>(physicsSignature);
         
         m_MouseInteractionSystem = m_World->RegisterSystem<MouseInteractionSystem>();
@@ -127,11 +128,19 @@ namespace UniversalEngine {
         m_MouseInteractionSystem->SetViewportSize(m_WindowWidth, m_WindowHeight);
         
         Signature mouseSignature;
-        mouseSignature.insert(ComponentTypeRegistry::GetTypeID<Transform2D>());
-        mouseSignature.insert(ComponentTypeRegistry::GetTypeID<BoxCollider2D>());
-        mouseSignature.insert(ComponentTypeRegistry::GetTypeID<Rigidbody2D>());
+        mouseSignature.set(ComponentTypeRegistry::GetTypeID<Transform2D>());
+        mouseSignature.set(ComponentTypeRegistry::GetTypeID<BoxCollider2D>());
+        mouseSignature.set(ComponentTypeRegistry::GetTypeID<Rigidbody2D>());
         m_World->SetSystemSignature<MouseInteractionSystem>(mouseSignature);
         
+        m_TransformHierarchySystem = m_World->RegisterSystem<TransformHierarchySystem>();
+        m_TransformHierarchySystem->SetWorld(m_World.get());
+        
+        Signature hierarchySignature;
+        hierarchySignature.set(ComponentTypeRegistry::GetTypeID<Transform2D>());
+        hierarchySignature.set(ComponentTypeRegistry::GetTypeID<WorldTransform2D>());
+        m_World->SetSystemSignature<TransformHierarchySystem>(hierarchySignature);
+        
         m_World->ecs_flush();
     }
     
@@ -154,13 +163,15 @@ namespace UniversalEngine {
             ImGui::Text("Time: %.2f", m_Time);
             ImGui::Text("Entity Count: %zu", m_World->GetEntityCount());
             
-            if (m_World->HasComponent<Scene>(m_SceneEntity)) {
-                auto& scene = m_World->GetComponent<Scene>(m_SceneEntity);
+            if (Scene* scene = m_World->TryGetResource<Scene>()) {
                 ImGui::Separator();
                 ImGui::Text("Scene Settings");
-                ImGui::SliderFloat("Time Scale", &scene.timeScale, 0.0f, 3.0f);
+                ImGui::SliderFloat("Time Scale", &scene->timeScale, 0.0f, 3.0f);
                 if (ImGui::Button("Reset Time Scale")) {
-                    scene.timeScale = 1.0f;
+                    scene->timeScale = 1.0f;
+                }
+                if (Physics2DSettings* physics = m_World->TryGetResource<Physics2DSettings>()) {
+                    ImGui::DragFloat2("Gravity", &physics->gravity.x, 0.1f);
                 }
                 ImGui::Separator();
             }
@@ -176,16 +187,16 @@ namespace UniversalEngine {
             ImGui::Begin("Entity Inspector");
             
             for (EntityID entityID = 1; entityID < m_World->GetEntityCount() + 1; ++entityID) {
-                Entity entity(entityID);
+                Entity entity = m_World->GetEntity(entityID);
                 
-                if (!m_World->IsEntityValid(entity)) {
+                if (!entity.IsValid()) {
                     continue;
                 }
                 
                 if (ImGui::TreeNode((void*)(intptr_t)entityID, "Entity %u", entityID)) {
                     if (m_World->HasComponent<Transform2D>(entity)) {
-                        auto& transform = m_World->GetComponent<Transform2D>(entity);
                         if (ImGui::TreeNode("Transform2D")) {
+                            auto& transform = m_World->GetMut<Transform2D>(entity);
                             ImGui::DragFloat2("Position", &transform.position.x, 0.1f);
                             ImGui::SliderFloat("Rotation", &transform.rotation, -180.0f, 180.0f);
                             ImGui::DragFloat2("Scale", &transform.scale.x, 0.01f, 0.01f, 10.0f);
@@ -194,8 +205,8 @@ namespace UniversalEngine {
                     }
                     
                     if (m_World->HasComponent<Rigidbody2D>(entity)) {
-                        auto& rb = m_World->GetComponent<Rigidbody2D>(entity);
                         if (ImGui::TreeNode("Rigidbody2D")) {
+                            auto& rb = m_World->GetMut<Rigidbody2D>(entity);
                             ImGui::DragFloat2("Velocity", &rb.velocity.x, 0.1f);
                             ImGui::SliderFloat("Angular Velocity", &rb.angularVelocity, -10.0f, 10.0f);
                             ImGui::SliderFloat("Mass", &rb.mass, 0.1f, 10.0f);
@@ -210,8 +221,8 @@ namespace UniversalEngine {
                     }
                     
                     if (m_World->HasComponent<MeshRenderer2D>(entity)) {
-                        auto& mesh = m_World->GetComponent<MeshRenderer2D>(entity);
                         if (ImGui::TreeNode("MeshRenderer2D")) {
+                            auto& mesh = m_World->GetMut<MeshRenderer2D>(entity);
                             ImGui::DragFloat2("Size", &mesh.size.x, 0.1f, 0.1f, 10.0f);
                             ImGui::ColorEdit4("Color", &mesh.color.x);
                             ImGui::Checkbox("Visible", &mesh.visible);
@@ -220,8 +231,8 @@ namespace UniversalEngine {
                     }
                     
                     if (m_World->HasComponent<BoxCollider2D>(entity)) {
-                        auto& collider = m_World->GetComponent<BoxCollider2D>(entity);
                         if (ImGui::TreeNode("BoxCollider2D")) {
+                            auto& collider = m_World->GetMut<BoxCollider2D>(entity);
                             ImGui::DragFloat2("Size", &collider.size.x, 0.1f, 0.1f, 10.0f);
                             ImGui::DragFloat2("Offset", &collider.offset.x, 0.1f);
                             ImGui::Checkbox("Is Trigger", &collider.isTrigger);
@@ -238,10 +249,21 @@ namespace UniversalEngine {
         }
         
         float scaledDeltaTime = deltaTime;
-        if (m_World->HasComponent<Scene>(m_SceneEntity)) {
-            auto& scene = m_World->GetComponent<Scene>(m_SceneEntity);
-            scaledDeltaTime = scene.GetScaledDeltaTime(deltaTime);
+        if (const Scene* scene = m_World->TryGetResource<Scene>()) {
+            scaledDeltaTime = scene->GetScaledDeltaTime(deltaTime);
+        }
+        
+        // simulation advances in fixed steps; rendering blends the last two of them
+        int steps = m_FixedTimestep.Advance(scaledDeltaTime);
+        for (int step = 0; step < steps; ++step) {
+            if (step == steps - 1) {
+                m_RenderSystem->CapturePreviousTransforms(*m_World);
+            }
+            m_World->FixedUpdate(m_FixedTimestep.GetStep());
+            // spawns and removals from one step are in place before the next one runs
+            m_World->ecs_flush();
         }
+        m_RenderSystem->SetInterpolationAlpha(m_FixedTimestep.GetAlpha());
         
         m_World->Update(scaledDeltaTime);
     }
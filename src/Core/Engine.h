@@ -3,9 +3,12 @@
 #include <chrono>
 #include "../Renderer/OpenGL/OpenGLContext.h"
 #include "ECS/World.h"
+#include "Jobs/JobSystem.h"
+#include "Time/FixedTimestep.h"
 #include "Systems/RenderSystem2D.h"
 #include "Systems/Physics2DSystem.h"
 #include "Systems/MouseInteractionSystem.h"
+#include "Systems/TransformHierarchySystem.h"
 
 namespace UniversalEngine {
     class Engine {
@@ -41,12 +44,15 @@ namespace UniversalEngine {
         std::chrono::steady_clock::time_point lastDelta = std::chrono::steady_clock::now();
         float deltaTime = 0.0f;
         
+        // 60 Hz simulation whatever the render rate
+        FixedTimestep m_FixedTimestep{ 1.0f / 60.0f, 5 };
+        
+        std::unique_ptr<JobSystem> m_JobSystem;
         std::unique_ptr<World> m_World;
         std::shared_ptr<RenderSystem2D> m_RenderSystem;
         std::shared_ptr<Physics2DSystem> m_PhysicsSystem;
         std::shared_ptr<MouseInteractionSystem> m_MouseInteractionSystem;
-        
-        Entity m_SceneEntity;
+        std::shared_ptr<TransformHierarchySystem> m_TransformHierarchySystem;
     };
     
     Engine* CreateApplication();
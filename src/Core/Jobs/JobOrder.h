@@ -0,0 +1,45 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <array>
+
+namespace UniversalEngine {
+    
+    // Where a piece of work sits in the order a serial run would have done it, whichever
+    // thread runs it. Each level is one step down the tree of spawned work: a job spawned as
+    // its parent's i-th child appends 2i + 2, and work the parent submits itself after
+    // spawning k children appends 2k + 1, so it sorts after those children and before the
+    // next. Unused levels are 0 and keys compare lexicographically. Work nested deeper than
+    // MAX_DEPTH levels shares its ancestor's key, and loses its order against its siblings.
+    struct JobKey {
+        static constexpr std::size_t MAX_DEPTH = 6;
+        
+        std::array<std::uint32_t, MAX_DEPTH> path{};
+        
+        JobKey Append(std::uint32_t step) const {
+            JobKey key = *this;
+            for (std::uint32_t& level : key.path) {
+                if (level == 0) {
+                    level = step;
+                    break;
+                }
+            }
+            return key;
+        }
+        
+        bool operator<(const JobKey& other) const { return path < other.path; }
+        bool operator==(const JobKey& other) const { return path == other.path; }
+    };
+    
+    // stamped on anything jobs hand back for a later merge (World commands, say): sorting by
+    // it gives the same order on every run, however the jobs were spread over threads
+    struct SubmissionOrder {
+        JobKey key;
+        std::uint64_t sequence = 0;
+        
+        bool operator<(const SubmissionOrder& other) const {
+            return key < other.key || (key == other.key && sequence < other.sequence);
+        }
+    };
+
+}
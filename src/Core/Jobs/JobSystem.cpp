@@ -0,0 +1,221 @@
+#include "JobSystem.h"
+#include <stdexcept>
+
+namespace UniversalEngine {
+    
+    namespace {
+        // the pool a worker belongs to travels with its index, so a thread of another pool
+        // (or one the application spawned) is never mistaken for one of ours
+        struct ThreadIdentity {
+            const JobSystem* pool = nullptr;
+            std::size_t index = 0;
+        };
+        
+        thread_local ThreadIdentity s_Thread;
+        
+        // the ordering scope of whatever the thread is running: the key of the job (or of
+        // nothing, at the top), the children it has spawned and the submissions it has made
+        struct OrderState {
+            JobKey key;
+            std::uint32_t spawned = 0;
+            std::uint64_t submitted = 0;
+        };
+        
+        thread_local OrderState s_Order;
+    }
+    
+    JobSystem::OrderScope::OrderScope(const JobKey& key)
+        : m_Key(s_Order.key), m_Spawned(s_Order.spawned), m_Submitted(s_Order.submitted) {
+        s_Order.key = key;
+        s_Order.spawned = 0;
+        s_Order.submitted = 0;
+    }
+    
+    JobSystem::OrderScope::~OrderScope() {
+        s_Order.key = m_Key;
+        s_Order.spawned = m_Spawned;
+        s_Order.submitted = m_Submitted;
+    }
+    
+    JobKey JobSystem::SpawnKeys(std::uint32_t count) {
+        JobKey first = s_Order.key.Append(2 * s_Order.spawned + 2);
+        s_Order.spawned += count;
+        return first;
+    }
+    
+    JobKey JobSystem::SiblingKey(const JobKey& first, std::uint32_t offset) {
+        JobKey key = first;
+        for (std::size_t level = JobKey::MAX_DEPTH; level-- > 0;) {
+            if (key.path[level] != 0) {
+                // past MAX_DEPTH, Append() left the key alone and siblings share it
+                if (!(key == s_Order.key)) {
+                    key.path[level] += 2 * offset;
+                }
+                break;
+            }
+        }
+        return key;
+    }
+    
+    SubmissionOrder JobSystem::NextSubmissionOrder(std::uint64_t count) {
+        SubmissionOrder order;
+        order.key = s_Order.key.Append(2 * s_Order.spawned + 1);
+        order.sequence = s_Order.submitted;
+        s_Order.submitted += count;
+        return order;
+    }
+    
+    void JobSystem::ResetSubmissionOrder() {
+        s_Order.spawned = 0;
+        s_Order.submitted = 0;
+    }
+    
+    JobSystem::JobSystem(std::size_t workerCount) : m_OwnerThread(std::this_thread::get_id()) {
+        if (workerCount == 0) {
+            unsigned int hardwareThreads = std::thread::hardware_concurrency();
+            workerCount = hardwareThreads > 1 ? hardwareThreads - 1 : 0;
+        }
+        
+        for (std::size_t i = 0; i <= workerCount; ++i) {
+            m_Queues.push_back(std::make_unique<WorkQueue>());
+        }
+        
+        m_Workers.reserve(workerCount);
+        for (std::size_t i = 1; i <= workerCount; ++i) {
+            m_Workers.emplace_back([this, i]() { WorkerLoop(i); });
+        }
+    }
+    
+    JobSystem::~JobSystem() {
+        {
+            std::lock_guard<std::mutex> lock(m_SleepMutex);
+            m_Stopping = true;
+        }
+        m_WakeUp.notify_all();
+        
+        for (std::thread& worker : m_Workers) {
+            worker.join();
+        }
+    }
+    
+    std::size_t JobSystem::GetThreadIndex() const {
+        if (s_Thread.pool == this) {
+            return s_Thread.index;
+        }
+        return std::this_thread::get_id() == m_OwnerThread ? 0 : NOT_A_POOL_THREAD;
+    }
+    
+    std::size_t JobSystem::GetQueueIndex() const {
+        return s_Thread.pool == this ? s_Thread.index : 0;
+    }
+    
+    void JobSystem::Schedule(const Job& job) {
+        // the counter is where a failing job's exception goes; without one it would have
+        // nowhere to go but std::terminate on the worker
+        if (!job.counter) {
+            throw std::runtime_error("JobSystem::Schedule needs a job with a counter");
+        }
+        job.counter->m_Pending.fetch_add(1, std::memory_order_relaxed);
+        
+        WorkQueue& queue = *m_Queues[GetQueueIndex()];
+        {
+            std::lock_guard<std::mutex> lock(queue.mutex);
+            queue.jobs.push_back(job);
+        }
+        
+        {
+            std::lock_guard<std::mutex> lock(m_SleepMutex);
+            m_QueuedJobs.fetch_add(1, std::memory_order_relaxed);
+        }
+        m_WakeUp.notify_one();
+    }
+    
+    void JobSystem::Wait(JobCounter& counter) {
+        WaitWithoutRethrow(counter);
+        
+        if (counter.m_Failed.load(std::memory_order_relaxed)) {
+            std::exception_ptr exception = counter.m_Exception;
+            counter.m_Exception = nullptr;
+            counter.m_Failed.store(false, std::memory_order_relaxed);
+            std::rethrow_exception(exception);
+        }
+    }
+    
+    void JobSystem::WaitWithoutRethrow(JobCounter& counter) {
+        while (!counter.IsDone()) {
+            if (!TryRunJob(GetQueueIndex())) {
+                std::this_thread::yield();
+            }
+        }
+    }
+    
+    void JobSystem::WorkerLoop(std::size_t threadIndex) {
+        s_Thread.pool = this;
+        s_Thread.index = threadIndex;
+        
+        while (true) {
+            if (TryRunJob(threadIndex)) {
+                continue;
+            }
+            
+            std::unique_lock<std::mutex> lock(m_SleepMutex);
+            m_WakeUp.wait(lock, [this]() { return m_Stopping || m_QueuedJobs.load(std::memory_order_relaxed) > 0; });
+            if (m_Stopping && m_QueuedJobs.load(std::memory_order_relaxed) == 0) {
+                return;
+            }
+        }
+    }
+    
+    bool JobSystem::TryRunJob(std::size_t threadIndex) {
+        Job job;
+        if (!PopOwn(threadIndex, job) && !Steal(threadIndex, job)) {
+            return false;
+        }
+        
+        m_QueuedJobs.fetch_sub(1, std::memory_order_relaxed);
+        Execute(job);
+        return true;
+    }
+    
+    bool JobSystem::PopOwn(std::size_t threadIndex, Job& job) {
+        WorkQueue& queue = *m_Queues[threadIndex < m_Queues.size() ? threadIndex : 0];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        if (queue.jobs.empty()) {
+            return false;
+        }
+        
+        job = queue.jobs.back();
+        queue.jobs.pop_back();
+        return true;
+    }
+    
+    bool JobSystem::Steal(std::size_t threadIndex, Job& job) {
+        std::size_t queueCount = m_Queues.size();
+        for (std::size_t offset = 1; offset < queueCount; ++offset) {
+            WorkQueue& queue = *m_Queues[(threadIndex + offset) % queueCount];
+            std::lock_guard<std::mutex> lock(queue.mutex);
+            if (queue.jobs.empty()) {
+                continue;
+            }
+            
+            job = queue.jobs.front();
+            queue.jobs.pop_front();
+            return true;
+        }
+        return false;
+    }
+    
+    void JobSystem::Execute(const Job& job) {
+        OrderScope scope(job.key);
+        
+        // an exception escaping a worker would terminate the process; hand it to whoever waits
+        try {
+            job.entry(job.data, job.begin, job.end);
+        } catch (...) {
+            job.counter->Fail(std::current_exception());
+        }
+        
+        job.counter->m_Pending.fetch_sub(1, std::memory_order_acq_rel);
+    }
+
+}
@@ -0,0 +1,231 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <atomic>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <vector>
+#include <algorithm>
+#include <numeric>
+#include <type_traits>
+#include <exception>
+#include "JobOrder.h"
+
+namespace UniversalEngine {
+    
+    // number of outstanding jobs in a batch; Wait() on it until it drops to zero. The first
+    // exception a job of the batch throws is kept here and rethrown by Wait()
+    class JobCounter {
+    public:
+        JobCounter() = default;
+        
+        JobCounter(const JobCounter&) = delete;
+        JobCounter& operator=(const JobCounter&) = delete;
+        
+        bool IsDone() const { return m_Pending.load(std::memory_order_acquire) == 0; }
+    
+    private:
+        friend class JobSystem;
+        
+        // written before the failing job's decrement of m_Pending, so it is visible once IsDone()
+        void Fail(std::exception_ptr exception) {
+            bool expected = false;
+            if (m_Failed.compare_exchange_strong(expected, true, std::memory_order_relaxed)) {
+                m_Exception = exception;
+            }
+        }
+        
+        std::atomic<std::uint32_t> m_Pending{ 0 };
+        std::atomic<bool> m_Failed{ false };
+        std::exception_ptr m_Exception;
+    };
+    
+    // a job is a plain function pointer plus an index range; no allocation per job
+    struct Job {
+        void (*entry)(void* data, std::size_t begin, std::size_t end) = nullptr;
+        void* data = nullptr;
+        std::size_t begin = 0;
+        std::size_t end = 0;
+        JobCounter* counter = nullptr;
+        JobKey key;
+    };
+    
+    // Fixed set of workers, one deque each. Owners push and pop at the back, idle workers
+    // steal from the front of other deques. Thread index 0 is the thread that created the
+    // JobSystem; it helps execute jobs while it waits. Any other thread may schedule and wait
+    // too (it shares queue 0), but it has no thread index of its own.
+    class JobSystem {
+    public:
+        static constexpr std::size_t CACHE_LINE_SIZE = 64;
+        
+        // Rounds grainSize up so a range of that many elements is a whole number of cache lines
+        // in every one of the Ts arrays: 64 / gcd(64, sizeof(T)) elements per T, lcm across Ts.
+        // Range boundaries then sit a whole number of lines apart; the arrays are plain
+        // std::vectors, not line-aligned, so neighbouring ranges can still share the one line
+        // a boundary falls in, but no more.
+        template<typename... Ts>
+        static std::size_t CacheAlignedGrain(std::size_t grainSize) {
+            std::size_t multiple = 1;
+            ((multiple = std::lcm(multiple, CACHE_LINE_SIZE / std::gcd(CACHE_LINE_SIZE, std::max(sizeof(Ts), std::size_t(1))))), ...);
+            grainSize = std::max(grainSize, std::size_t(1));
+            return (grainSize + multiple - 1) / multiple * multiple;
+        }
+        
+        // 0 sizes the pool from std::thread::hardware_concurrency(), leaving one core to the caller
+        explicit JobSystem(std::size_t workerCount = 0);
+        ~JobSystem();
+        
+        JobSystem(const JobSystem&) = delete;
+        JobSystem& operator=(const JobSystem&) = delete;
+        
+        // job.counter is required
+        void Schedule(const Job& job);
+        
+        // runs queued jobs on the calling thread until counter reaches zero, then rethrows the
+        // first exception any of its jobs threw
+        void Wait(JobCounter& counter);
+        
+        // Wait() that leaves a job's exception in the counter; for unwinding paths that must
+        // not let queued jobs outlive the stack they point into
+        void WaitWithoutRethrow(JobCounter& counter);
+        
+        // fn() is copied into the job; counter must outlive it
+        template<typename Func>
+        void Run(JobCounter& counter, Func&& fn) {
+            using Callable = std::decay_t<Func>;
+            
+            Job job;
+            job.entry = [](void* data, std::size_t, std::size_t) {
+                std::unique_ptr<Callable> callable(static_cast<Callable*>(data));
+                (*callable)();
+            };
+            job.data = new Callable(std::forward<Func>(fn));
+            job.counter = &counter;
+            job.key = SpawnKeys(1);
+            Schedule(job);
+        }
+        
+        // runs fn() on the calling thread, ordered as if Run() had spawned it here
+        template<typename Func>
+        static void RunInline(Func&& fn) {
+            OrderScope scope(SpawnKeys(1));
+            fn();
+        }
+        
+        // the calling thread's next SubmissionOrder; count > 1 reserves a run of sequences
+        // for a batch, the first of which is returned
+        static SubmissionOrder NextSubmissionOrder(std::uint64_t count = 1);
+        
+        // starts the calling thread's current ordering scope over, for when nothing stamped in
+        // it is pending any more (World::ecs_flush()); keeps the counters from wrapping
+        static void ResetSubmissionOrder();
+        
+        // splits [0, count) into ranges of at most grainSize and calls fn(begin, end) for
+        // each, on any thread; returns once every range has run. Range r is ordered as the
+        // caller's next-but-r spawned child, however many workers there are
+        template<typename Func>
+        void ParallelFor(std::size_t count, std::size_t grainSize, Func&& fn) {
+            if (count == 0) {
+                return;
+            }
+            
+            grainSize = std::max<std::size_t>(grainSize, 1);
+            std::size_t rangeCount = (count + grainSize - 1) / grainSize;
+            JobKey firstKey = SpawnKeys(static_cast<std::uint32_t>(rangeCount));
+            if (count <= grainSize || m_Workers.empty()) {
+                OrderScope scope(firstKey);
+                fn(std::size_t(0), count);
+                return;
+            }
+            
+            using Callable = std::remove_reference_t<Func>;
+            
+            JobCounter counter;
+            Job job;
+            job.entry = [](void* data, std::size_t begin, std::size_t end) {
+                (*static_cast<Callable*>(data))(begin, end);
+            };
+            job.data = const_cast<void*>(static_cast<const void*>(&fn));
+            job.counter = &counter;
+            
+            // the first range is kept for the calling thread
+            for (std::size_t begin = grainSize; begin < count; begin += grainSize) {
+                job.begin = begin;
+                job.end = std::min(begin + grainSize, count);
+                job.key = SiblingKey(firstKey, static_cast<std::uint32_t>(begin / grainSize));
+                Schedule(job);
+            }
+            
+            // the queued ranges point at fn and counter, so they must finish before unwinding
+            try {
+                OrderScope scope(firstKey);
+                fn(std::size_t(0), grainSize);
+            } catch (...) {
+                WaitWithoutRethrow(counter);
+                throw;
+            }
+            Wait(counter);
+        }
+        
+        std::size_t GetWorkerCount() const { return m_Workers.size(); }
+        
+        // workers plus the calling thread
+        std::size_t GetThreadCount() const { return m_Workers.size() + 1; }
+        
+        static constexpr std::size_t NOT_A_POOL_THREAD = ~std::size_t(0);
+        
+        // 0 on the thread that created this JobSystem, 1..GetWorkerCount() on its workers,
+        // NOT_A_POOL_THREAD anywhere else (including workers of another JobSystem)
+        std::size_t GetThreadIndex() const;
+    
+    private:
+        // swaps in a fresh ordering scope for key on the calling thread, restoring the
+        // enclosing one on destruction
+        class OrderScope {
+        public:
+            explicit OrderScope(const JobKey& key);
+            ~OrderScope();
+            
+            OrderScope(const OrderScope&) = delete;
+            OrderScope& operator=(const OrderScope&) = delete;
+        
+        private:
+            JobKey m_Key;
+            std::uint32_t m_Spawned;
+            std::uint64_t m_Submitted;
+        };
+        
+        // keys for the next count children of the calling thread's scope; returns the first
+        static JobKey SpawnKeys(std::uint32_t count);
+        
+        // the key offset children after first, spawned in the same SpawnKeys() call
+        static JobKey SiblingKey(const JobKey& first, std::uint32_t offset);
+        
+        struct WorkQueue {
+            std::mutex mutex;
+            std::deque<Job> jobs;
+        };
+        
+        // GetThreadIndex(), with outside threads mapped onto queue 0
+        std::size_t GetQueueIndex() const;
+        
+        void WorkerLoop(std::size_t threadIndex);
+        bool TryRunJob(std::size_t threadIndex);
+        bool PopOwn(std::size_t threadIndex, Job& job);
+        bool Steal(std::size_t threadIndex, Job& job);
+        void Execute(const Job& job);
+        
+        std::vector<std::unique_ptr<WorkQueue>> m_Queues;
+        std::vector<std::thread> m_Workers;
+        std::thread::id m_OwnerThread;
+        
+        std::atomic<std::size_t> m_QueuedJobs{ 0 };
+        std::mutex m_SleepMutex;
+        std::condition_variable m_WakeUp;
+        bool m_Stopping = false;
+    };
+
+}
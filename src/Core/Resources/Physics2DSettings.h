@@ -0,0 +1,11 @@
+#pragma once
+#include <glm/glm.hpp>
+
+namespace UniversalEngine {
+    
+    // World resource read by Physics2DSystem every step
+    struct Physics2DSettings {
+        glm::vec2 gravity{0.0f, -9.81f};
+    };
+
+}
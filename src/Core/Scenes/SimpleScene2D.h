@@ -1,6 +1,7 @@
 #pragma once
 #include "../ECS/World.h"
 #include "../ECS/Entity.h"
+#include "../ECS/Prefab.h"
 #include "../Components/Transform2D.h"
 #include "../Components/MeshRenderer2D.h"
 #include "../Components/BoxCollider2D.h"
@@ -22,24 +23,21 @@ namespace UniversalEngine {
             CreatePlatform(world);
         }
         
+        static const Prefab& GetBoxPrefab() {
+            static const Prefab prefab = []() {
+                Prefab box;
+                box.Set(Transform2D(glm::vec2(0.0f), glm::vec2(1.0f, 1.0f), 0.0f));
+                box.Set(MeshRenderer2D(glm::vec2(1.0f, 1.0f), glm::vec4(1.0f, 0.5f, 0.2f, 1.0f)));
+                box.Set(BoxCollider2D(glm::vec2(1.0f, 1.0f), false, false));
+                box.Set(Rigidbody2D(1.0f, 1.0f, true));
+                return box;
+            }();
+            return prefab;
+        }
+        
         static Entity CreateBox(World& world, glm::vec2 position) {
-            Entity box = world.CreateEntity();
-            
-            Transform2D transform;
-            transform.position = position;
-            transform.scale = glm::vec2(1.0f, 1.0f);
-            transform.rotation = 0.0f;
-            world.AddComponent(box, std::move(transform));
-            
-            MeshRenderer2D meshRenderer(glm::vec2(1.0f, 1.0f), glm::vec4(1.0f, 0.5f, 0.2f, 1.0f));
-            world.AddComponent(box, std::move(meshRenderer));
-            
-            BoxCollider2D collider(glm::vec2(1.0f, 1.0f), false, false);
-            world.AddComponent(box, std::move(collider));
-            
-            Rigidbody2D rigidbody(1.0f, 1.0f, true);
-            world.AddComponent(box, std::move(rigidbody));
-            
+            Entity box = world.Instantiate(GetBoxPrefab());
+            world.GetComponent<Transform2D>(box).position = position;
             return box;
         }
         
@@ -39,8 +39,8 @@ namespace UniversalEngine {
                 m_GrabbedEntity = FindEntityAtPosition(worldPos);
                 if (m_GrabbedEntity.GetID() != 0) {
                     m_IsDragging = true;
-                    auto& transform = m_World->GetComponent<Transform2D>(m_GrabbedEntity);
-                    auto& rigidbody = m_World->GetComponent<Rigidbody2D>(m_GrabbedEntity);
+                    const auto& transform = m_World->GetComponent<Transform2D>(m_GrabbedEntity);
+                    const auto& rigidbody = m_World->GetComponent<Rigidbody2D>(m_GrabbedEntity);
                     wasUsingGravity = rigidbody.useGravity;
                     m_DragOffset = transform.position - worldPos;
                 }
@@ -48,7 +48,8 @@ namespace UniversalEngine {
                 m_IsDragging = false;
                 if (m_World->HasComponent<Transform2D>(m_GrabbedEntity) &&
                     m_World->HasComponent<Rigidbody2D>(m_GrabbedEntity)) {   
-                    auto& rigidbody = m_World->GetComponent<Rigidbody2D>(m_GrabbedEntity);
+                    // GetMut() stamps the write, so ChangedSince<Rigidbody2D> consumers see it
+                    auto& rigidbody = m_World->GetMut<Rigidbody2D>(m_GrabbedEntity);
                     rigidbody.useGravity = wasUsingGravity;
                 }
                 m_GrabbedEntity = Entity(0);
@@ -58,8 +59,8 @@ namespace UniversalEngine {
                 if (m_World->HasComponent<Transform2D>(m_GrabbedEntity) &&
                     m_World->HasComponent<Rigidbody2D>(m_GrabbedEntity)) {
                     
-                    auto& transform = m_World->GetComponent<Transform2D>(m_GrabbedEntity);
-                    auto& rigidbody = m_World->GetComponent<Rigidbody2D>(m_GrabbedEntity);
+                    const auto& transform = m_World->GetComponent<Transform2D>(m_GrabbedEntity);
+                    auto& rigidbody = m_World->GetMut<Rigidbody2D>(m_GrabbedEntity);
                     
                     glm::vec2 targetPos = worldPos + m_DragOffset;
                     glm::vec2 direction = targetPos - transform.position;
@@ -100,23 +101,14 @@ namespace UniversalEngine {
         }
         
         Entity FindEntityAtPosition(const glm::vec2& worldPos) {
-            for (auto entity : m_Entities) {
-                if (!m_World->HasComponent<Transform2D>(entity) ||
-                    !m_World->HasComponent<BoxCollider2D>(entity)) {
-                    continue;
-                }
-                
-                auto& transform = m_World->GetComponent<Transform2D>(entity);
-                auto& collider = m_World->GetComponent<BoxCollider2D>(entity);
-                
+            for (auto [entity, transform, collider, rigidbody] :
+                 m_World->View<const Transform2D, const BoxCollider2D, const Rigidbody2D>()) {
                 glm::vec2 min = transform.position + collider.offset - collider.size * transform.scale * 0.5f;
                 glm::vec2 max = transform.position + collider.offset + collider.size * transform.scale * 0.5f;
                 
                 if (worldPos.x >= min.x && worldPos.x <= max.x &&
                     worldPos.y >= min.y && worldPos.y <= max.y) {
-                    if (m_World->HasComponent<Rigidbody2D>(entity)) {
-                        return entity;
-                    }
+                    return entity;
                 }
             }
             
@@ -4,35 +4,34 @@
 #include "../Components/Transform2D.h"
 #include "../Components/Rigidbody2D.h"
 #include "../Components/BoxCollider2D.h"
+#include "../Resources/Physics2DSettings.h"
 #include <glm/glm.hpp>
 #include <glm/gtc/constants.hpp>
+#include <optional>
+#include <stdexcept>
 
 namespace UniversalEngine {
     
-    class Physics2DSystem : public System {
+    class Physics2DSystem : public PhysicsSystem {
     public:
         Physics2DSystem() = default;
         ~Physics2DSystem() = default;
         
         void Init() override {
-            m_Gravity = glm::vec2(0.0f, -9.81f);
+            DeclareWrites<Transform2D, Rigidbody2D, BoxCollider2D>();
         }
         
-        
-        void Update(float deltaTime) override {
-            for (auto entity : m_Entities) {
-                if (!m_World) continue;
-                
-                if (!m_World->HasComponent<Transform2D>(entity) || 
-                    !m_World->HasComponent<Rigidbody2D>(entity)) {
-                    continue;
-                }
-                
-                auto& transform = m_World->GetComponent<Transform2D>(entity);
-                auto& rigidbody = m_World->GetComponent<Rigidbody2D>(entity);
-                
+        // a fixed step keeps integration and collision response independent of the frame rate
+        void FixedUpdate(float deltaTime) override {
+            if (!m_World) return;
+            
+            glm::vec2 gravity = GetGravity();
+            
+            // owning group: the three arrays are packed in lockstep, so this is a linear walk;
+            // bodies are independent, so it is split across the job system when there is one
+            auto integrate = [gravity, deltaTime](Entity, Transform2D& transform, Rigidbody2D& rigidbody, const BoxCollider2D&) {
                 if (rigidbody.useGravity) {
-                    rigidbody.velocity += m_Gravity * rigidbody.gravityScale * deltaTime;
+                    rigidbody.velocity += gravity * rigidbody.gravityScale * deltaTime;
                 }
                 
                 float speed = glm::length(rigidbody.velocity);
@@ -42,68 +41,85 @@ namespace UniversalEngine {
                 }
                 
                 transform.position += rigidbody.velocity * deltaTime;
+            };
+            
+            if (JobSystem* jobSystem = m_World->GetJobSystem()) {
+                m_Group->ParallelEach(*jobSystem, integrate, INTEGRATION_GRAIN);
+            } else {
+                m_Group->Each(integrate);
             }
             
-            std::vector<Entity> entityList(m_Entities.begin(), m_Entities.end());
-            for (size_t i = 0; i < entityList.size(); ++i) {
-                auto entity = entityList[i];
-                if (!m_World->HasComponent<Transform2D>(entity) || 
-                    !m_World->HasComponent<BoxCollider2D>(entity)) {
-                    continue;
-                }
-                
-                auto& transform = m_World->GetComponent<Transform2D>(entity);
-                auto& collider = m_World->GetComponent<BoxCollider2D>(entity);
-                bool hasRigidbody = m_World->HasComponent<Rigidbody2D>(entity);
+            // gather every collider once so the pair loop works on plain pointers; read-only,
+            // so resting static colliders are not stamped as changed
+            m_Bodies.clear();
+            m_World->View<const Transform2D, const BoxCollider2D>().Each(
+                [&](Entity entity, const Transform2D& transform, const BoxCollider2D& collider) {
+                    m_Bodies.push_back({ entity, &transform, &collider, m_World->TryGetComponent<Rigidbody2D>(entity) });
+                });
+            
+            for (size_t i = 0; i < m_Bodies.size(); ++i) {
+                const Transform2D& transform = *m_Bodies[i].transform;
+                const BoxCollider2D& collider = *m_Bodies[i].collider;
+                const Rigidbody2D* rigidbody = m_Bodies[i].rigidbody;
                 
-                for (size_t j = i + 1; j < entityList.size(); ++j) {
-                    auto otherEntity = entityList[j];
-                    
-                    if (!m_World->HasComponent<Transform2D>(otherEntity) ||
-                        !m_World->HasComponent<BoxCollider2D>(otherEntity)) {
-                        continue;
-                    }
-                    
-                    auto& otherTransform = m_World->GetComponent<Transform2D>(otherEntity);
-                    auto& otherCollider = m_World->GetComponent<BoxCollider2D>(otherEntity);
+                for (size_t j = i + 1; j < m_Bodies.size(); ++j) {
+                    const Transform2D& otherTransform = *m_Bodies[j].transform;
+                    const BoxCollider2D& otherCollider = *m_Bodies[j].collider;
+                    const Rigidbody2D* otherRigidbody = m_Bodies[j].rigidbody;
                     
                     if (IntersectsOBB(transform.position, transform.rotation, collider, 
                                      otherTransform.position, otherTransform.rotation, otherCollider)) {
-                        bool otherHasRigidbody = m_World->HasComponent<Rigidbody2D>(otherEntity);
-                        
-                        if (hasRigidbody && !otherHasRigidbody && otherCollider.isStatic) {
-                            auto& rigidbody = m_World->GetComponent<Rigidbody2D>(entity);
-                            ResolveStaticCollision(transform, rigidbody, collider, otherTransform, otherCollider);
+                        // GetMut() stamps both components, so ChangedSince<Rigidbody2D> sees responses
+                        Entity entity = m_Bodies[i].entity;
+                        Entity otherEntity = m_Bodies[j].entity;
+                        if (rigidbody && !otherRigidbody && otherCollider.isStatic) {
+                            ResolveStaticCollision(m_World->GetMut<Transform2D>(entity), m_World->GetMut<Rigidbody2D>(entity), collider,
+                                                   otherTransform, otherCollider);
                         }
-                        else if (!hasRigidbody && otherHasRigidbody && collider.isStatic) {
-                            auto& otherRigidbody = m_World->GetComponent<Rigidbody2D>(otherEntity);
-                            ResolveStaticCollision(otherTransform, otherRigidbody, otherCollider, transform, collider);
+                        else if (!rigidbody && otherRigidbody && collider.isStatic) {
+                            ResolveStaticCollision(m_World->GetMut<Transform2D>(otherEntity), m_World->GetMut<Rigidbody2D>(otherEntity), otherCollider,
+                                                   transform, collider);
                         }
-                        else if (hasRigidbody && otherHasRigidbody) {
-                            auto& rigidbody = m_World->GetComponent<Rigidbody2D>(entity);
-                            auto& otherRigidbody = m_World->GetComponent<Rigidbody2D>(otherEntity);
-                            ResolveDynamicCollision(transform, rigidbody, collider, 
-                                                   otherTransform, otherRigidbody, otherCollider);
+                        else if (rigidbody && otherRigidbody) {
+                            ResolveDynamicCollision(m_World->GetMut<Transform2D>(entity), m_World->GetMut<Rigidbody2D>(entity), collider, 
+                                                   m_World->GetMut<Transform2D>(otherEntity), m_World->GetMut<Rigidbody2D>(otherEntity), otherCollider);
                         }
                     }
                 }
             }
         }
         
+        // Creates the owning group the integration walks, here rather than mid-step, where it
+        // would register types and reorder arrays under systems running alongside. The group
+        // owns Transform2D, Rigidbody2D and BoxCollider2D, so World::Sort and AlignTo refuse
+        // to reorder those types once physics is set up. Colliders are owned read-only, so
+        // stepping leaves ChangedSince<BoxCollider2D> alone.
         void SetWorld(World* world) {
             m_World = world;
+            m_Group.emplace(m_World->Group<Transform2D, Rigidbody2D, const BoxCollider2D>());
         }
         
+        // gravity is shared config, so it lives in the World's Physics2DSettings resource rather
+        // than on the system; these forward to it, and the default applies until it is set
         void SetGravity(const glm::vec2& gravity) {
-            m_Gravity = gravity;
+            if (!m_World) {
+                throw std::runtime_error("Physics2DSystem::SetGravity called before SetWorld");
+            }
+            if (Physics2DSettings* settings = m_World->TryGetResource<Physics2DSettings>()) {
+                settings->gravity = gravity;
+            } else {
+                m_World->SetResource(Physics2DSettings{ gravity });
+            }
         }
         
         glm::vec2 GetGravity() const {
-            return m_Gravity;
+            const World* world = m_World;
+            const Physics2DSettings* settings = world ? world->TryGetResource<Physics2DSettings>() : nullptr;
+            return settings ? settings->gravity : Physics2DSettings().gravity;
         }
         
     private:
-        void ResolveStaticCollision(Transform2D& transform, Rigidbody2D& rigidbody, BoxCollider2D& collider,
+        void ResolveStaticCollision(Transform2D& transform, Rigidbody2D& rigidbody, const BoxCollider2D& collider,
                                     const Transform2D& otherTransform, const BoxCollider2D& otherCollider) {
             detail::OBB A = detail::makeOBB(transform.position, transform.rotation, collider);
             detail::OBB B = detail::makeOBB(otherTransform.position, otherTransform.rotation, otherCollider);
@@ -131,8 +147,8 @@ namespace UniversalEngine {
             }
         }
 
-        void ResolveDynamicCollision(Transform2D& transform1, Rigidbody2D& rb1, BoxCollider2D& collider1,
-                                    Transform2D& transform2, Rigidbody2D& rb2, BoxCollider2D& collider2) {
+        void ResolveDynamicCollision(Transform2D& transform1, Rigidbody2D& rb1, const BoxCollider2D& collider1,
+                                    Transform2D& transform2, Rigidbody2D& rb2, const BoxCollider2D& collider2) {
             detail::OBB A = detail::makeOBB(transform1.position, transform1.rotation, collider1);
             detail::OBB B = detail::makeOBB(transform2.position, transform2.rotation, collider2);
             glm::vec2 n;
@@ -178,8 +194,19 @@ namespace UniversalEngine {
         }
         
     private:
-        glm::vec2 m_Gravity{0.0f, -9.81f};
+        static constexpr size_t INTEGRATION_GRAIN = 2048;
+        
+        struct Body {
+            Entity entity;
+            const Transform2D* transform;
+            const BoxCollider2D* collider;
+            const Rigidbody2D* rigidbody;  // read-only; responses write through GetMut()
+        };
+        
+        // kept for the group and the collider view; configuration lives in World resources
         World* m_World = nullptr;
+        std::optional<OwningGroup<Transform2D, Rigidbody2D, const BoxCollider2D>> m_Group;
+        std::vector<Body> m_Bodies;
     };
     
 }
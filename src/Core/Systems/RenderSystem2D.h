@@ -3,13 +3,16 @@
 #include "../ECS/World.h"
 #include "../Components/Transform2D.h"
 #include "../Components/MeshRenderer2D.h"
+#include "../Components/WorldTransform2D.h"
 #include "../../Renderer/Shader.h"
 #include "../../Renderer/VertexArray.h"
 #include "../../Renderer/Buffer.h"
 #include <GL/glew.h>
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
+#include <cmath>
 #include <memory>
+#include <vector>
 
 namespace UniversalEngine {
     
@@ -19,6 +22,7 @@ namespace UniversalEngine {
         ~RenderSystem2D() = default;
         
         void Init() override {
+            DeclareReads<Transform2D, WorldTransform2D, MeshRenderer2D>();
             SetupShader();
             SetupQuadVAO();
         }
@@ -31,6 +35,24 @@ namespace UniversalEngine {
         void Update(float deltaTime) override {
         }
         
+        // call right before the last fixed step of a frame: the transforms it keeps are what
+        // Render() blends from, so that is the state one step behind the newest
+        void CapturePreviousTransforms(World& world) {
+            m_PreviousStepTick = m_StepTick;
+            m_StepTick = world.AdvanceTick();
+            
+            world.View<const Transform2D, const MeshRenderer2D>().Each(
+                [&](Entity entity, const Transform2D& transform, const MeshRenderer2D&) {
+                    if (entity.GetID() >= m_PreviousTransforms.size()) {
+                        m_PreviousTransforms.resize(entity.GetID() + 1);
+                    }
+                    m_PreviousTransforms[entity.GetID()] = { entity, transform };
+                });
+        }
+        
+        // how far rendering is between the previous and the newest fixed step, in [0, 1)
+        void SetInterpolationAlpha(float alpha) { m_Alpha = alpha; }
+        
         void Render(World& world) {
             if (!m_Shader || !m_QuadVAO) {
                 return;
@@ -46,30 +68,62 @@ namespace UniversalEngine {
             glm::mat4 projection = glm::ortho(-orthoWidth, orthoWidth, -orthoHeight, orthoHeight, -1.0f, 1.0f);
             m_Shader->SetMat4("u_Projection", projection);
             
-            for (auto entity : m_Entities) {
-                if (!world.HasComponent<Transform2D>(entity) || 
-                    !world.HasComponent<MeshRenderer2D>(entity)) {
-                    continue;
-                }
-                
-                auto& transform = world.GetComponent<Transform2D>(entity);
-                auto& meshRenderer = world.GetComponent<MeshRenderer2D>(entity);
-                
-                if (!meshRenderer.visible) {
-                    continue;
-                }
-                
-                glm::mat4 model = glm::mat4(1.0f);
-                model = glm::translate(model, glm::vec3(transform.position, 0.0f));
-                model = glm::rotate(model, glm::radians((float)transform.rotation), glm::vec3(0.0f, 0.0f, 1.0f));
-                model = glm::scale(model, glm::vec3(transform.scale * meshRenderer.size, 1.0f));
-                
-                m_Shader->SetMat4("u_Model", model);
-                m_Shader->SetFloat4("u_Color", meshRenderer.color);
-                
-                m_QuadVAO->Bind();
-                glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, nullptr);
+            // only entities whose transform or mesh changed since the last frame rebuild their
+            // model matrix; static scenery keeps the cached one. Anything moved by either of the
+            // last two fixed steps is rebuilt every frame, since alpha moves it between them
+            Tick since = m_LastRenderTick;
+            if (IsNewerTick(since, m_PreviousStepTick)) {
+                since = m_PreviousStepTick;
             }
+            m_LastRenderTick = world.AdvanceTick();
+            
+            auto renderables = world.View<const Transform2D, const MeshRenderer2D>();
+            renderables.ChangedSince<Transform2D, MeshRenderer2D>(since).Each(
+                [&](Entity entity, const Transform2D& transform, const MeshRenderer2D& meshRenderer) {
+                    if (entity.GetID() >= m_ModelMatrices.size()) {
+                        m_ModelMatrices.resize(entity.GetID() + 1);
+                    }
+                    
+                    Transform2D blended = transform;
+                    if (entity.GetID() < m_PreviousTransforms.size() && m_PreviousTransforms[entity.GetID()].entity == entity) {
+                        blended = Interpolate(m_PreviousTransforms[entity.GetID()].transform, transform, m_Alpha);
+                    }
+                    
+                    glm::mat4 model = glm::mat4(1.0f);
+                    model = glm::translate(model, glm::vec3(blended.position, 0.0f));
+                    model = glm::rotate(model, glm::radians((float)blended.rotation), glm::vec3(0.0f, 0.0f, 1.0f));
+                    model = glm::scale(model, glm::vec3(blended.scale * meshRenderer.size, 1.0f));
+                    m_ModelMatrices[entity.GetID()] = model;
+                });
+            
+            // entities in a transform hierarchy are placed by their composed world transform
+            world.View<const WorldTransform2D, const MeshRenderer2D>().ChangedSince<WorldTransform2D, MeshRenderer2D>(since).Each(
+                [&](Entity entity, const WorldTransform2D& worldTransform, const MeshRenderer2D& meshRenderer) {
+                    if (entity.GetID() >= m_ModelMatrices.size()) {
+                        m_ModelMatrices.resize(entity.GetID() + 1);
+                    }
+                    
+                    const glm::mat3& matrix = worldTransform.matrix;
+                    glm::mat4 model = glm::mat4(1.0f);
+                    model[0] = glm::vec4(matrix[0].x, matrix[0].y, 0.0f, 0.0f);
+                    model[1] = glm::vec4(matrix[1].x, matrix[1].y, 0.0f, 0.0f);
+                    model[3] = glm::vec4(matrix[2].x, matrix[2].y, 0.0f, 1.0f);
+                    model = glm::scale(model, glm::vec3(meshRenderer.size, 1.0f));
+                    m_ModelMatrices[entity.GetID()] = model;
+                });
+            
+            renderables.Each(
+                [&](Entity entity, const Transform2D& transform, const MeshRenderer2D& meshRenderer) {
+                    if (!meshRenderer.visible) {
+                        return;
+                    }
+                    
+                    m_Shader->SetMat4("u_Model", m_ModelMatrices[entity.GetID()]);
+                    m_Shader->SetFloat4("u_Color", meshRenderer.color);
+                    
+                    m_QuadVAO->Bind();
+                    glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, nullptr);
+                });
         }
         
         void Shutdown() override {
@@ -77,6 +131,18 @@ namespace UniversalEngine {
             m_QuadVAO.reset();
         }
         
+        // rotation takes the short way round
+        static Transform2D Interpolate(const Transform2D& previous, const Transform2D& current, float alpha) {
+            float turn = current.rotation - previous.rotation;
+            turn -= 360.0f * std::round(turn / 360.0f);
+            
+            Transform2D blended;
+            blended.position = glm::mix(previous.position, current.position, alpha);
+            blended.scale = glm::mix(previous.scale, current.scale, alpha);
+            blended.rotation = previous.rotation + turn * alpha;
+            return blended;
+        }
+    
     private:
         void SetupShader() {
             std::string vertexShaderSource = R"(
@@ -131,12 +197,28 @@ namespace UniversalEngine {
             auto indexBuffer = IndexBuffer::Create(indices, 6);
             m_QuadVAO->SetIndexBuffer(indexBuffer);
         }
-        
+    
     private:
         std::shared_ptr<Shader> m_Shader;
         std::shared_ptr<VertexArray> m_QuadVAO;
+        
+        struct PreviousTransform {
+            Entity entity;  // stale once the slot is reused
+            Transform2D transform;
+        };
+        
+        // indexed by EntityID
+        std::vector<glm::mat4> m_ModelMatrices;
+        std::vector<PreviousTransform> m_PreviousTransforms;
+        Tick m_LastRenderTick = 0;
+        
+        // closed by the last two CapturePreviousTransforms() calls
+        Tick m_StepTick = 0;
+        Tick m_PreviousStepTick = 0;
+        float m_Alpha = 1.0f;
+        
         uint32_t m_ViewportWidth = 1280;
         uint32_t m_ViewportHeight = 720;
     };
-    
+
 }
@@ -0,0 +1,247 @@
+#pragma once
+#include "../ECS/System.h"
+#include "../ECS/World.h"
+#include "../Components/Transform2D.h"
+#include "../Components/WorldTransform2D.h"
+#include "../Components/Parent.h"
+#include <glm/glm.hpp>
+#include <cmath>
+#include <vector>
+
+namespace UniversalEngine {
+    
+    // Composes each member's Transform2D with its Parent's world transform into WorldTransform2D.
+    // Members (signature Transform2D + WorldTransform2D) are kept as one node list in which every
+    // root's subtree is contiguous and breadth-first, so a parent always precedes its children
+    // and propagation is a single forward pass. Only subtrees holding a changed Transform2D are
+    // visited, in parallel on the World's job system; within them a node is only recomputed
+    // when its Transform2D or an ancestor's changed.
+    class TransformHierarchySystem : public System {
+    public:
+        TransformHierarchySystem() = default;
+        ~TransformHierarchySystem() = default;
+        
+        void Init() override {
+            DeclareReads<Transform2D, Parent>();
+            DeclareWrites<WorldTransform2D>();
+            
+            // after everything that moves local transforms this frame
+            SetPriority(HIERARCHY_PRIORITY);
+        }
+        
+        void SetWorld(World* world) {
+            m_World = world;
+            m_Stale = true;
+            
+            // a removed Parent leaves no change tick behind, so it is watched directly
+            m_World->OnDestroy<Parent>([this](Span<const Entity>) { m_Stale = true; });
+        }
+        
+        void OnEntitiesAdded(Span<const Entity>) override { m_Stale = true; }
+        void OnEntitiesRemoved(Span<const Entity>) override { m_Stale = true; }
+        
+        void Update(float) override {
+            if (!m_World) return;
+            
+            ComponentArray<Transform2D>* locals = m_World->FindComponentArray<Transform2D>();
+            ComponentArray<WorldTransform2D>* worlds = m_World->FindComponentArray<WorldTransform2D>();
+            if (!locals || !worlds) return;
+            
+            Tick since = GetLastRunTick();
+            
+            // reparenting shows up as a Parent added or written since the last run
+            if (!m_Stale) {
+                m_World->View<const Parent>().ChangedSince<Parent>(since).Each(
+                    [this](Entity, const Parent&) { m_Stale = true; });
+            }
+            
+            bool rebuilt = m_Stale;
+            if (m_Stale) {
+                Rebuild();
+                m_Stale = false;
+            }
+            
+            if (m_Subtrees.size() < 2) return;
+            
+            // flag the nodes whose own Transform2D changed and collect the subtrees holding them;
+            // every other subtree is clean all the way down and is not visited
+            size_t subtreeCount = m_Subtrees.size() - 1;
+            m_DirtySubtrees.clear();
+            if (rebuilt) {
+                for (size_t subtree = 0; subtree < subtreeCount; ++subtree) {
+                    m_DirtySubtrees.push_back(static_cast<std::uint32_t>(subtree));
+                }
+            } else {
+                m_SubtreeQueued.assign(subtreeCount, 0);
+                m_World->View<const Transform2D>().ChangedSince<Transform2D>(since).Each(
+                    [this](Entity entity, const Transform2D&) {
+                        EntityID entityID = entity.GetID();
+                        std::uint32_t node = entityID < m_NodeOf.size() ? m_NodeOf[entityID] : NO_PARENT;
+                        if (node == NO_PARENT) {
+                            return;
+                        }
+                        m_Changed[node] = 1;
+                        std::uint32_t subtree = m_SubtreeOf[node];
+                        if (!m_SubtreeQueued[subtree]) {
+                            m_SubtreeQueued[subtree] = 1;
+                            m_DirtySubtrees.push_back(subtree);
+                        }
+                    });
+            }
+            
+            if (m_DirtySubtrees.empty()) return;
+            
+            auto propagate = [&](size_t first, size_t last) {
+                for (size_t k = first; k < last; ++k) {
+                    std::uint32_t subtree = m_DirtySubtrees[k];
+                    for (size_t i = m_Subtrees[subtree]; i < m_Subtrees[subtree + 1]; ++i) {
+                        Node& node = m_Nodes[i];
+                        bool dirty = rebuilt || m_Changed[i] || (node.parent != NO_PARENT && m_Dirty[node.parent]);
+                        m_Dirty[i] = dirty;
+                        m_Changed[i] = 0;
+                        if (!dirty) {
+                            continue;
+                        }
+                        
+                        EntityID entity = node.entity.GetID();
+                        glm::mat3 local = LocalMatrix(locals->GetDataAt(locals->GetIndex(entity)));
+                        node.world = node.parent != NO_PARENT ? m_Nodes[node.parent].world * local : local;
+                        
+                        std::uint32_t worldIndex = worlds->GetIndex(entity);
+                        worlds->GetDataAt(worldIndex).matrix = node.world;
+                        worlds->MarkChangedAt(worldIndex);
+                    }
+                }
+            };
+            
+            if (JobSystem* jobSystem = m_World->GetJobSystem()) {
+                jobSystem->ParallelFor(m_DirtySubtrees.size(), SUBTREE_GRAIN, propagate);
+            } else {
+                propagate(0, m_DirtySubtrees.size());
+            }
+        }
+        
+        // number of nodes reachable from a root; members caught in a parent cycle are left out
+        size_t GetNodeCount() const { return m_Nodes.size(); }
+        size_t GetRootCount() const { return m_Subtrees.empty() ? 0 : m_Subtrees.size() - 1; }
+        
+        static glm::mat3 LocalMatrix(const Transform2D& transform) {
+            float radians = glm::radians(transform.rotation);
+            float c = std::cos(radians);
+            float s = std::sin(radians);
+            return glm::mat3(glm::vec3(c * transform.scale.x, s * transform.scale.x, 0.0f),
+                             glm::vec3(-s * transform.scale.y, c * transform.scale.y, 0.0f),
+                             glm::vec3(transform.position, 1.0f));
+        }
+    
+    private:
+        static constexpr std::uint32_t NO_PARENT = ~std::uint32_t(0);
+        static constexpr int HIERARCHY_PRIORITY = 1000;
+        static constexpr size_t SUBTREE_GRAIN = 16;
+        
+        struct Node {
+            Entity entity;
+            std::uint32_t parent;  // index into m_Nodes, always lower than this node's
+            glm::mat3 world;
+        };
+        
+        // lays the members out root by root, each subtree breadth-first
+        void Rebuild() {
+            Span<const Entity> members = GetEntities();
+            
+            m_SlotOf.clear();
+            for (size_t slot = 0; slot < members.size(); ++slot) {
+                EntityID entity = members[slot].GetID();
+                if (entity >= m_SlotOf.size()) {
+                    m_SlotOf.resize(entity + 1, NO_PARENT);
+                }
+                m_SlotOf[entity] = static_cast<std::uint32_t>(slot);
+            }
+            
+            // parent slot of every member; an entity parented to a non-member is a root
+            m_ParentSlots.assign(members.size(), NO_PARENT);
+            m_ChildOffsets.assign(members.size() + 1, 0);
+            for (size_t slot = 0; slot < members.size(); ++slot) {
+                const Parent* parent = m_World->TryGetComponent<Parent>(members[slot]);
+                if (parent && parent->entity != members[slot] && HasEntity(parent->entity)) {
+                    m_ParentSlots[slot] = m_SlotOf[parent->entity.GetID()];
+                    ++m_ChildOffsets[m_ParentSlots[slot] + 1];
+                }
+            }
+            
+            // children grouped by parent slot: m_Children[m_ChildOffsets[p], m_ChildOffsets[p + 1])
+            for (size_t slot = 0; slot < members.size(); ++slot) {
+                m_ChildOffsets[slot + 1] += m_ChildOffsets[slot];
+            }
+            m_Children.resize(members.size());
+            m_ChildCursor.assign(m_ChildOffsets.begin(), m_ChildOffsets.end() - 1);
+            for (size_t slot = 0; slot < members.size(); ++slot) {
+                if (m_ParentSlots[slot] != NO_PARENT) {
+                    m_Children[m_ChildCursor[m_ParentSlots[slot]]++] = static_cast<std::uint32_t>(slot);
+                }
+            }
+            
+            m_Nodes.clear();
+            m_NodeSlots.clear();
+            m_Subtrees.clear();
+            for (size_t slot = 0; slot < members.size(); ++slot) {
+                if (m_ParentSlots[slot] != NO_PARENT) {
+                    continue;
+                }
+                
+                m_Subtrees.push_back(m_Nodes.size());
+                m_Nodes.push_back({ members[slot], NO_PARENT, glm::mat3(1.0f) });
+                m_NodeSlots.push_back(static_cast<std::uint32_t>(slot));
+                
+                // the node list doubles as the breadth-first queue
+                for (size_t head = m_Subtrees.back(); head < m_Nodes.size(); ++head) {
+                    std::uint32_t parentSlot = m_NodeSlots[head];
+                    for (std::uint32_t c = m_ChildOffsets[parentSlot]; c < m_ChildOffsets[parentSlot + 1]; ++c) {
+                        m_Nodes.push_back({ members[m_Children[c]], static_cast<std::uint32_t>(head), glm::mat3(1.0f) });
+                        m_NodeSlots.push_back(m_Children[c]);
+                    }
+                }
+            }
+            m_Subtrees.push_back(m_Nodes.size());
+            
+            m_NodeOf.assign(m_SlotOf.size(), NO_PARENT);
+            m_SubtreeOf.resize(m_Nodes.size());
+            for (size_t subtree = 0; subtree + 1 < m_Subtrees.size(); ++subtree) {
+                for (size_t i = m_Subtrees[subtree]; i < m_Subtrees[subtree + 1]; ++i) {
+                    m_NodeOf[m_Nodes[i].entity.GetID()] = static_cast<std::uint32_t>(i);
+                    m_SubtreeOf[i] = static_cast<std::uint32_t>(subtree);
+                }
+            }
+            
+            m_Dirty.assign(m_Nodes.size(), 1);
+            m_Changed.assign(m_Nodes.size(), 0);
+        }
+        
+        World* m_World = nullptr;
+        bool m_Stale = true;
+        
+        std::vector<Node> m_Nodes;
+        std::vector<std::uint8_t> m_Dirty;  // bytes, not vector<bool>: subtrees write it in parallel
+        std::vector<std::uint8_t> m_Changed;  // own Transform2D changed; cleared once visited
+        
+        // m_Nodes[m_Subtrees[k], m_Subtrees[k + 1]) is the k-th root's subtree
+        std::vector<size_t> m_Subtrees;
+        
+        // EntityID -> node index (NO_PARENT if not a node), node index -> subtree
+        std::vector<std::uint32_t> m_NodeOf;
+        std::vector<std::uint32_t> m_SubtreeOf;
+        
+        // subtrees to visit this run, in the order they were found
+        std::vector<std::uint32_t> m_DirtySubtrees;
+        std::vector<std::uint8_t> m_SubtreeQueued;
+        
+        // Rebuild() scratch
+        std::vector<std::uint32_t> m_SlotOf;
+        std::vector<std::uint32_t> m_ParentSlots;
+        std::vector<std::uint32_t> m_ChildOffsets;
+        std::vector<std::uint32_t> m_ChildCursor;
+        std::vector<std::uint32_t> m_Children;
+        std::vector<std::uint32_t> m_NodeSlots;
+    };
+
+}
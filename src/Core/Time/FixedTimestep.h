@@ -0,0 +1,47 @@
+#pragma once
+#include <algorithm>
+#include <cmath>
+
+namespace UniversalEngine {
+    
+    // Turns variable frame times into a whole number of fixed simulation steps. Time that does
+    // not fill a step carries over to the next frame; GetAlpha() is how far the carried time
+    // gets into the next step, for blending the last two simulated states when rendering.
+    class FixedTimestep {
+    public:
+        explicit FixedTimestep(float stepSeconds = 1.0f / 60.0f, int maxStepsPerFrame = 5)
+            : m_Step(stepSeconds), m_MaxSteps(maxStepsPerFrame) {}
+        
+        // adds a frame's time and returns how many steps to run for it. A frame that would need
+        // more than the limit (a hitch, a breakpoint) drops the backlog instead of letting slow
+        // steps pile up into ever longer frames
+        int Advance(float frameSeconds) {
+            m_Accumulator += frameSeconds;
+            
+            int steps = static_cast<int>(m_Accumulator / m_Step);
+            if (steps > m_MaxSteps) {
+                steps = m_MaxSteps;
+                m_Accumulator = std::fmod(m_Accumulator, m_Step);
+            } else {
+                m_Accumulator = std::max(m_Accumulator - steps * m_Step, 0.0f);
+            }
+            return steps;
+        }
+        
+        float GetAlpha() const { return m_Accumulator / m_Step; }
+        
+        float GetStep() const { return m_Step; }
+        void SetStep(float stepSeconds) { m_Step = stepSeconds; }
+        
+        int GetMaxStepsPerFrame() const { return m_MaxSteps; }
+        void SetMaxStepsPerFrame(int maxSteps) { m_MaxSteps = maxSteps; }
+        
+        void Reset() { m_Accumulator = 0.0f; }
+    
+    private:
+        float m_Step;
+        int m_MaxSteps;
+        float m_Accumulator = 0.0f;
+    };
+
+}
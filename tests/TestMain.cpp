@@ -2,10 +2,19 @@
 
 #include "ECSTest.h"
 #include "../src/Core/ECS/World.h"
+#include "../src/Core/Jobs/JobSystem.h"
 #include "../src/Core/Components/TestComponent.h"
+#include "../src/Core/Systems/TransformHierarchySystem.h"
+#include "../src/Core/Systems/Physics2DSystem.h"
+#include "../src/Core/Time/FixedTimestep.h"
 #include <iostream>
 #include <string>
 #include <map>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <sstream>
+#include <cstring>
 
 using namespace UniversalEngine;
 using namespace UniversalEngine::Testing;
@@ -18,6 +27,169 @@ bool TestComponentRemoval();
 bool TestMultipleComponents();
 bool TestEntityDestruction();
 bool TestPendingOperationCount();
+bool TestSignatureMatching();
+bool TestComponentSwapRemove();
+bool TestStaleEntityHandle();
+bool TestArchetypeStorage();
+bool TestCommandBufferBatching();
+bool TestComponentView();
+bool TestOwningGroup();
+bool TestSystemReverseIndex();
+bool TestSystemEntitySet();
+bool TestSystemScheduling();
+bool TestJobSystem();
+bool TestJobExceptions();
+bool TestParallelEach();
+bool TestThreadCommandBuffers();
+bool TestDeterministicCommands();
+bool TestBulkEntities();
+bool TestPrefabInstantiate();
+bool TestPointerStableStorage();
+bool TestPodComponents();
+bool TestChangeDetection();
+bool TestBatchedObservers();
+bool TestArraySorting();
+bool TestTransformHierarchy();
+bool TestWorldSnapshot();
+bool TestRollback();
+bool TestFixedTimestep();
+bool TestWorldResources();
+bool TestPhysicsGroup();
+
+class TestSystem : public System {
+public:
+    int addedCount = 0;
+    int removedCount = 0;
+    
+    void OnEntityAdded(Entity entity) override { ++addedCount; }
+    void OnEntityRemoved(Entity entity) override { ++removedCount; }
+};
+
+class OtherTestComponent : public Component {
+public:
+    OtherTestComponent(float value = 0.0f) : value(value) {}
+    
+    float value;
+};
+
+class OtherTestSystem : public TestSystem {};
+
+class AccessTestSystem : public System {
+public:
+    std::atomic<int>* clock = nullptr;
+    int ranAt = -1;
+    
+    void Update(float deltaTime) override {
+        ranAt = clock ? (*clock)++ : -1;
+    }
+};
+
+class TestWriterSystem : public AccessTestSystem {};
+class OtherWriterSystem : public AccessTestSystem {};
+class TestReaderSystem : public AccessTestSystem {};
+class ExclusiveSystem : public AccessTestSystem {};
+
+class StableTestComponent : public Component {
+public:
+    StableTestComponent(int value = 0) : value(value) {}
+    
+    int value;
+};
+
+namespace UniversalEngine {
+    template<>
+    struct ComponentStorageTraits<StableTestComponent> {
+        static constexpr bool STABLE_POINTERS = true;
+        static constexpr std::size_t PAGE_SIZE = 16;
+    };
+}
+
+struct PodTestComponent {
+    int value;
+    float weight;
+};
+
+namespace UniversalEngine {
+    template<> struct IsPODComponent<PodTestComponent> : std::true_type {};
+}
+
+// counts TestComponents written since its previous run
+class ChangeWatchSystem : public System {
+public:
+    World* world = nullptr;
+    int changed = 0;
+    
+    void Update(float deltaTime) override {
+        changed = 0;
+        world->View<const TestComponent>().ChangedSince<TestComponent>(GetLastRunTick()).Each(
+            [&](Entity, const TestComponent&) { ++changed; });
+    }
+};
+
+class FixedStepTestSystem : public PhysicsSystem {
+public:
+    std::atomic<int> steps{0};
+    float simulated = 0.0f;
+    
+    void Init() override {
+        DeclareReads<TestComponent>();
+    }
+    
+    void FixedUpdate(float fixedDeltaTime) override {
+        ++steps;
+        simulated += fixedDeltaTime;
+    }
+};
+
+class OtherFixedStepTestSystem : public FixedStepTestSystem {};
+
+class SpawningTestSystem : public System {
+public:
+    World* world = nullptr;
+    Prefab prefab;
+    bool createThrew = false;
+    bool instantiateThrew = false;
+    Entity reserved;
+    
+    void Init() override {
+        DeclareReads<TestComponent>();
+    }
+    
+    void Update(float deltaTime) override {
+        try {
+            world->CreateEntity();
+        } catch (const std::runtime_error&) {
+            createThrew = true;
+        }
+        try {
+            world->Instantiate(prefab);
+        } catch (const std::runtime_error&) {
+            instantiateThrew = true;
+        }
+        reserved = world->ReserveEntity();
+    }
+};
+
+class ThrowingTestSystem : public System {
+public:
+    void Init() override {
+        DeclareReads<TestComponent>();
+    }
+    
+    void Update(float deltaTime) override {
+        throw std::runtime_error("system failed");
+    }
+};
+
+// records the size of each membership batch it is handed
+class BatchTestSystem : public System {
+public:
+    std::vector<size_t> addedBatches;
+    std::vector<size_t> removedBatches;
+    
+    void OnEntitiesAdded(Span<const Entity> entities) override { addedBatches.push_back(entities.size()); }
+    void OnEntitiesRemoved(Span<const Entity> entities) override { removedBatches.push_back(entities.size()); }
+};
 
 bool TestEntityCreation() {
     World world;
@@ -166,6 +338,1474 @@ bool TestPendingOperationCount() {
     return true;
 }
 
+bool TestSignatureMatching() {
+    World world;
+    auto system = world.RegisterSystem<TestSystem>();
+    
+    Signature signature;
+    signature.set(ComponentTypeRegistry::GetTypeID<TestComponent>());
+    world.SetSystemSignature<TestSystem>(signature);
+    
+    auto entity = world.CreateEntity();
+    auto other = world.CreateEntity();
+    
+    world.AddComponent<TestComponent>(entity, TestComponent(1));
+    world.ecs_flush();
+    
+    ASSERT_TRUE(system->HasEntity(entity));
+    ASSERT_FALSE(system->HasEntity(other));
+    
+    world.RemoveComponent<TestComponent>(entity);
+    world.ecs_flush();
+    
+    ASSERT_FALSE(system->HasEntity(entity));
+    
+    return true;
+}
+
+bool TestComponentSwapRemove() {
+    World world;
+    auto entity1 = world.CreateEntity();
+    auto entity2 = world.CreateEntity();
+    auto entity3 = world.CreateEntity();
+    
+    world.AddComponent<TestComponent>(entity1, TestComponent(1));
+    world.AddComponent<TestComponent>(entity2, TestComponent(2));
+    world.AddComponent<TestComponent>(entity3, TestComponent(3));
+    world.ecs_flush();
+    
+    // removing from the middle moves the last element into the hole
+    world.RemoveComponent<TestComponent>(entity1);
+    world.ecs_flush();
+    
+    ASSERT_FALSE(world.HasComponent<TestComponent>(entity1));
+    ASSERT_EQ(world.GetComponent<TestComponent>(entity2).GetValue(), 2);
+    ASSERT_EQ(world.GetComponent<TestComponent>(entity3).GetValue(), 3);
+    
+    world.AddComponent<TestComponent>(entity1, TestComponent(4));
+    world.ecs_flush();
+    
+    ASSERT_EQ(world.GetComponent<TestComponent>(entity1).GetValue(), 4);
+    ASSERT_EQ(world.GetComponent<TestComponent>(entity3).GetValue(), 3);
+    
+    return true;
+}
+
+bool TestStaleEntityHandle() {
+    World world;
+    auto entity = world.CreateEntity();
+    
+    world.AddComponent<TestComponent>(entity, TestComponent(7));
+    world.ecs_flush();
+    world.DestroyEntity(entity);
+    
+    // the slot is recycled with a new generation
+    auto recycled = world.CreateEntity();
+    ASSERT_EQ(recycled.GetID(), entity.GetID());
+    ASSERT_TRUE(recycled != entity);
+    
+    ASSERT_FALSE(world.IsEntityValid(entity));
+    ASSERT_TRUE(world.IsEntityValid(recycled));
+    ASSERT_FALSE(world.HasComponent<TestComponent>(recycled));
+    ASSERT_TRUE(world.GetEntity(recycled.GetID()) == recycled);
+    
+    // pending operations on a stale handle are dropped at flush
+    world.AddComponent<TestComponent>(recycled, TestComponent(8));
+    world.DestroyEntity(recycled);
+    auto reused = world.CreateEntity();
+    world.ecs_flush();
+    ASSERT_FALSE(world.HasComponent<TestComponent>(reused));
+    
+    return true;
+}
+
+bool TestArchetypeStorage() {
+    World world(ComponentStorage::Archetype);
+    auto entity1 = world.CreateEntity();
+    auto entity2 = world.CreateEntity();
+    
+    world.AddComponent<TestComponent>(entity1, TestComponent(1));
+    world.AddComponent<TestComponent>(entity2, TestComponent(2));
+    world.AddComponent<OtherTestComponent>(entity2, OtherTestComponent(2.5f));
+    ASSERT_FALSE(world.HasComponent<TestComponent>(entity1));
+    world.ecs_flush();
+    
+    ASSERT_TRUE(world.HasComponent<TestComponent>(entity1));
+    ASSERT_FALSE(world.HasComponent<OtherTestComponent>(entity1));
+    ASSERT_EQ(world.GetComponent<TestComponent>(entity2).GetValue(), 2);
+    ASSERT_EQ(world.GetComponent<OtherTestComponent>(entity2).value, 2.5f);
+    
+    // moving entity1 into entity2's archetype keeps both values intact
+    world.AddComponent<OtherTestComponent>(entity1, OtherTestComponent(1.5f));
+    world.ecs_flush();
+    
+    int visited = 0;
+    int sum = 0;
+    world.ForEachChunk<TestComponent, OtherTestComponent>(
+        [&](size_t count, const EntityID* entities, TestComponent* tests, OtherTestComponent* others) {
+            for (size_t i = 0; i < count; ++i) {
+                sum += tests[i].GetValue();
+                ++visited;
+            }
+        });
+    ASSERT_EQ(visited, 2);
+    ASSERT_EQ(sum, 3);
+    
+    world.RemoveComponent<TestComponent>(entity1);
+    world.ecs_flush();
+    ASSERT_FALSE(world.HasComponent<TestComponent>(entity1));
+    ASSERT_EQ(world.GetComponent<OtherTestComponent>(entity1).value, 1.5f);
+    
+    world.DestroyEntity(entity2);
+    ASSERT_EQ(world.GetComponent<OtherTestComponent>(entity1).value, 1.5f);
+    
+    return true;
+}
+
+bool TestCommandBufferBatching() {
+    World world;
+    auto system = world.RegisterSystem<TestSystem>();
+    
+    Signature signature;
+    signature.set(ComponentTypeRegistry::GetTypeID<TestComponent>());
+    signature.set(ComponentTypeRegistry::GetTypeID<OtherTestComponent>());
+    world.SetSystemSignature<TestSystem>(signature);
+    
+    auto entity = world.CreateEntity();
+    auto other = world.CreateEntity();
+    
+    world.AddComponent<TestComponent>(entity, TestComponent(1));
+    world.AddComponent<OtherTestComponent>(entity, OtherTestComponent(1.0f));
+    world.AddComponent<TestComponent>(other, TestComponent(2));
+    world.RemoveComponent<TestComponent>(other);
+    ASSERT_EQ(world.GetPendingOperationCount(), 4);
+    
+    world.ecs_flush();
+    
+    // systems are re-evaluated once per touched entity, after every command has been applied
+    ASSERT_EQ(system->addedCount, 1);
+    ASSERT_TRUE(system->HasEntity(entity));
+    ASSERT_FALSE(world.HasComponent<TestComponent>(other));
+    ASSERT_EQ(world.GetPendingOperationCount(), 0);
+    
+    return true;
+}
+
+bool TestComponentView() {
+    World world;
+    auto both1 = world.CreateEntity();
+    auto onlyTest = world.CreateEntity();
+    auto both2 = world.CreateEntity();
+    
+    world.AddComponent<TestComponent>(both1, TestComponent(1));
+    world.AddComponent<TestComponent>(onlyTest, TestComponent(2));
+    world.AddComponent<TestComponent>(both2, TestComponent(3));
+    world.AddComponent<OtherTestComponent>(both1, OtherTestComponent(1.0f));
+    world.AddComponent<OtherTestComponent>(both2, OtherTestComponent(3.0f));
+    world.ecs_flush();
+    
+    int count = 0;
+    int sum = 0;
+    for (auto [entity, test, other] : world.View<TestComponent, const OtherTestComponent>()) {
+        ASSERT_TRUE(entity == both1 || entity == both2);
+        ASSERT_EQ(static_cast<float>(test.GetValue()), other.value);
+        test.SetValue(test.GetValue() * 10);
+        sum += test.GetValue();
+        ++count;
+    }
+    ASSERT_EQ(count, 2);
+    ASSERT_EQ(sum, 40);
+    ASSERT_EQ(world.GetComponent<TestComponent>(both2).GetValue(), 30);
+    
+    count = 0;
+    world.View<const TestComponent>().Each([&](Entity entity, const TestComponent& test) { ++count; });
+    ASSERT_EQ(count, 3);
+    
+    // a view over an unregistered type is empty rather than an error
+    World empty;
+    ASSERT_TRUE(empty.View<TestComponent>().begin() == empty.View<TestComponent>().end());
+    
+    return true;
+}
+
+bool TestOwningGroup() {
+    World world;
+    auto outside = world.CreateEntity();
+    auto member1 = world.CreateEntity();
+    auto member2 = world.CreateEntity();
+    
+    world.AddComponent<TestComponent>(outside, TestComponent(0));
+    world.AddComponent<TestComponent>(member1, TestComponent(1));
+    world.AddComponent<OtherTestComponent>(member1, OtherTestComponent(1.0f));
+    world.ecs_flush();
+    
+    auto group = world.Group<TestComponent, OtherTestComponent>();
+    ASSERT_EQ(group.Size(), 1);
+    
+    // joining after creation: the new member is packed into the group's prefix
+    world.AddComponent<TestComponent>(member2, TestComponent(2));
+    world.AddComponent<OtherTestComponent>(member2, OtherTestComponent(2.0f));
+    world.ecs_flush();
+    ASSERT_EQ(group.Size(), 2);
+    
+    int sum = 0;
+    bool inLockstep = true;
+    group.Each([&](Entity entity, TestComponent& test, OtherTestComponent& other) {
+        inLockstep = inLockstep && (entity == member1 || entity == member2) &&
+                     static_cast<float>(test.GetValue()) == other.value;
+        sum += test.GetValue();
+    });
+    ASSERT_TRUE(inLockstep);
+    ASSERT_EQ(sum, 3);
+    
+    // a const member is the same owned array, handed out read-only and left unstamped
+    auto readOnly = world.Group<TestComponent, const OtherTestComponent>();
+    ASSERT_EQ(readOnly.Size(), 2);
+    Tick before = world.AdvanceTick();
+    readOnly.Each([](Entity, TestComponent&, const OtherTestComponent&) {});
+    ASSERT_TRUE(world.HasChangedSince<TestComponent>(member1, before));
+    ASSERT_FALSE(world.HasChangedSince<OtherTestComponent>(member1, before));
+    
+    world.RemoveComponent<OtherTestComponent>(member1);
+    world.ecs_flush();
+    ASSERT_EQ(group.Size(), 1);
+    ASSERT_EQ(world.GetComponent<TestComponent>(member1).GetValue(), 1);
+    
+    world.DestroyEntity(member2);
+    ASSERT_EQ(group.Size(), 0);
+    ASSERT_EQ(world.GetComponent<TestComponent>(outside).GetValue(), 0);
+    
+    bool threw = false;
+    try {
+        world.Group<TestComponent>();
+    } catch (const std::runtime_error&) {
+        threw = true;
+    }
+    ASSERT_TRUE(threw);
+    
+    return true;
+}
+
+bool TestSystemReverseIndex() {
+    World world;
+    auto testSystem = world.RegisterSystem<TestSystem>();
+    auto otherSystem = world.RegisterSystem<OtherTestSystem>();
+    
+    Signature testSignature;
+    testSignature.set(ComponentTypeRegistry::GetTypeID<TestComponent>());
+    world.SetSystemSignature<TestSystem>(testSignature);
+    
+    Signature otherSignature;
+    otherSignature.set(ComponentTypeRegistry::GetTypeID<OtherTestComponent>());
+    world.SetSystemSignature<OtherTestSystem>(otherSignature);
+    
+    auto entity = world.CreateEntity();
+    world.AddComponent<TestComponent>(entity, TestComponent(1));
+    world.ecs_flush();
+    
+    ASSERT_EQ(testSystem->addedCount, 1);
+    ASSERT_EQ(otherSystem->addedCount, 0);
+    ASSERT_EQ(otherSystem->removedCount, 0);
+    
+    // an unrelated component change must not re-notify a system the entity already belongs to
+    world.AddComponent<OtherTestComponent>(entity, OtherTestComponent(1.0f));
+    world.ecs_flush();
+    
+    ASSERT_EQ(testSystem->addedCount, 1);
+    ASSERT_EQ(otherSystem->addedCount, 1);
+    
+    world.RemoveComponent<TestComponent>(entity);
+    world.ecs_flush();
+    
+    ASSERT_EQ(testSystem->removedCount, 1);
+    ASSERT_EQ(otherSystem->removedCount, 0);
+    
+    world.DestroyEntity(entity);
+    
+    ASSERT_EQ(testSystem->removedCount, 1);
+    ASSERT_EQ(otherSystem->removedCount, 1);
+    
+    return true;
+}
+
+bool TestSystemEntitySet() {
+    World world;
+    auto system = world.RegisterSystem<TestSystem>();
+    
+    Signature signature;
+    signature.set(ComponentTypeRegistry::GetTypeID<TestComponent>());
+    world.SetSystemSignature<TestSystem>(signature);
+    
+    std::vector<Entity> entities;
+    for (int i = 0; i < 4; ++i) {
+        entities.push_back(world.CreateEntity());
+    }
+    
+    // component array order is the reverse of entity creation order
+    for (int i = 3; i >= 0; --i) {
+        world.AddComponent<TestComponent>(entities[i], TestComponent(i));
+    }
+    world.ecs_flush();
+    
+    ASSERT_EQ(system->GetEntityCount(), 4);
+    ASSERT_TRUE(system->HasEntity(entities[2]));
+    
+    world.RemoveComponent<TestComponent>(entities[1]);
+    world.ecs_flush();
+    
+    ASSERT_EQ(system->GetEntities().size(), 3);
+    ASSERT_FALSE(system->HasEntity(entities[1]));
+    
+    world.SortSystemEntities<TestSystem, TestComponent>();
+    
+    auto sorted = system->GetEntities();
+    for (size_t i = 1; i < sorted.size(); ++i) {
+        auto& component = world.GetComponent<TestComponent>(sorted[i - 1]);
+        ASSERT_TRUE(component.GetValue() > world.GetComponent<TestComponent>(sorted[i]).GetValue());
+    }
+    
+    return true;
+}
+
+bool TestSystemScheduling() {
+    JobSystem jobSystem(2);
+    World world;
+    world.SetJobSystem(&jobSystem);
+    std::atomic<int> clock(0);
+    
+    auto testWriter = world.RegisterSystem<TestWriterSystem>();
+    auto otherWriter = world.RegisterSystem<OtherWriterSystem>();
+    auto testReader = world.RegisterSystem<TestReaderSystem>();
+    auto exclusive = world.RegisterSystem<ExclusiveSystem>();
+    
+    testWriter->DeclareWrites<TestComponent>();
+    otherWriter->DeclareWrites<OtherTestComponent>();
+    testReader->DeclareReads<TestComponent, OtherTestComponent>();
+    
+    for (AccessTestSystem* system : { static_cast<AccessTestSystem*>(testWriter.get()), static_cast<AccessTestSystem*>(otherWriter.get()),
+                                      static_cast<AccessTestSystem*>(testReader.get()), static_cast<AccessTestSystem*>(exclusive.get()) }) {
+        system->clock = &clock;
+    }
+    
+    // both writers share a stage; the reader waits for them; the undeclared system runs alone
+    ASSERT_EQ(world.GetScheduleStageCount(), 3);
+    
+    world.Update(0.016f);
+    
+    ASSERT_EQ(clock.load(), 4);
+    ASSERT_TRUE(testReader->ranAt > testWriter->ranAt);
+    ASSERT_TRUE(testReader->ranAt > otherWriter->ranAt);
+    ASSERT_EQ(exclusive->ranAt, 3);
+    
+    // raising the reader's priority above the writers puts it first
+    testReader->SetPriority(-1);
+    ASSERT_EQ(world.GetScheduleStageCount(), 3);
+    
+    world.Update(0.016f);
+    ASSERT_TRUE(testReader->ranAt < testWriter->ranAt);
+    
+    return true;
+}
+
+bool TestJobSystem() {
+    JobSystem jobSystem(3);
+    ASSERT_EQ(jobSystem.GetThreadCount(), 4);
+    ASSERT_EQ(jobSystem.GetThreadIndex(), 0u);
+    
+    std::vector<int> values(10000, 0);
+    jobSystem.ParallelFor(values.size(), 64, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            values[i] += static_cast<int>(i);
+        }
+    });
+    
+    for (size_t i = 0; i < values.size(); ++i) {
+        ASSERT_EQ(values[i], static_cast<int>(i));
+    }
+    
+    // jobs that schedule more jobs against the same counter
+    std::atomic<int> ran(0);
+    JobCounter counter;
+    for (int i = 0; i < 16; ++i) {
+        jobSystem.Run(counter, [&]() {
+            ++ran;
+            jobSystem.Run(counter, [&]() { ++ran; });
+        });
+    }
+    jobSystem.Wait(counter);
+    
+    ASSERT_EQ(ran.load(), 32);
+    
+    // thread indices belong to one pool: another pool's workers and other threads have none
+    JobSystem otherPool(2);
+    std::atomic<bool> foreignIndex(false);
+    otherPool.ParallelFor(64, 1, [&](size_t, size_t) {
+        if (otherPool.GetThreadIndex() != 0 && jobSystem.GetThreadIndex() != JobSystem::NOT_A_POOL_THREAD) {
+            foreignIndex = true;
+        }
+    });
+    ASSERT_FALSE(foreignIndex.load());
+    
+    size_t outsideIndex = 0;
+    std::thread outside([&]() { outsideIndex = jobSystem.GetThreadIndex(); });
+    outside.join();
+    ASSERT_EQ(outsideIndex, JobSystem::NOT_A_POOL_THREAD);
+    
+    // so a World refuses commands from them instead of sharing the main thread's buffer
+    World world;
+    world.SetJobSystem(&jobSystem);
+    Entity entity = world.CreateEntity();
+    bool outsideThrew = false;
+    std::thread spawner([&]() {
+        try {
+            world.AddComponent(entity, TestComponent(1));
+        } catch (const std::runtime_error&) {
+            outsideThrew = true;
+        }
+    });
+    spawner.join();
+    ASSERT_TRUE(outsideThrew);
+    ASSERT_EQ(world.GetPendingOperationCount(), 0u);
+    
+    return true;
+}
+
+bool TestJobExceptions() {
+    JobSystem jobSystem(3);
+    std::atomic<int> ran(0);
+    
+    // a range thrown on a worker reaches the caller after every range has finished
+    bool threw = false;
+    try {
+        jobSystem.ParallelFor(64, 1, [&](size_t begin, size_t end) {
+            ++ran;
+            if (begin == 40) {
+                throw std::runtime_error("range failed");
+            }
+        });
+    } catch (const std::runtime_error&) {
+        threw = true;
+    }
+    ASSERT_TRUE(threw);
+    ASSERT_EQ(ran.load(), 64);
+    
+    // so does one thrown by the calling thread's own range
+    ran = 0;
+    threw = false;
+    try {
+        jobSystem.ParallelFor(64, 1, [&](size_t begin, size_t end) {
+            ++ran;
+            if (begin == 0) {
+                throw std::runtime_error("range failed");
+            }
+        });
+    } catch (const std::runtime_error&) {
+        threw = true;
+    }
+    ASSERT_TRUE(threw);
+    ASSERT_EQ(ran.load(), 64);
+    
+    // Wait() rethrows once, leaving the counter reusable
+    JobCounter counter;
+    jobSystem.Run(counter, []() { throw std::runtime_error("job failed"); });
+    threw = false;
+    try {
+        jobSystem.Wait(counter);
+    } catch (const std::runtime_error&) {
+        threw = true;
+    }
+    ASSERT_TRUE(threw);
+    jobSystem.Run(counter, [&]() { ++ran; });
+    jobSystem.Wait(counter);
+    
+    // a job without a counter would have nowhere to report a failure, so it is refused
+    threw = false;
+    try {
+        jobSystem.Schedule(Job{});
+    } catch (const std::runtime_error&) {
+        threw = true;
+    }
+    ASSERT_TRUE(threw);
+    
+    // a system run on a worker fails World::Update instead of the process
+    World world;
+    world.SetJobSystem(&jobSystem);
+    world.RegisterSystem<FixedStepTestSystem>();
+    world.RegisterSystem<ThrowingTestSystem>();
+    ASSERT_EQ(world.GetScheduleStageCount(), 1u);
+    threw = false;
+    try {
+        world.Update(0.016f);
+    } catch (const std::runtime_error&) {
+        threw = true;
+    }
+    ASSERT_TRUE(threw);
+    
+    return true;
+}
+
+bool TestParallelEach() {
+    JobSystem jobSystem(3);
+    World world;
+    
+    const int count = 5000;
+    for (int i = 0; i < count; ++i) {
+        auto entity = world.CreateEntity();
+        world.AddComponent<TestComponent>(entity, TestComponent(i));
+        if (i % 2 == 0) {
+            world.AddComponent<OtherTestComponent>(entity, OtherTestComponent(0.0f));
+        }
+    }
+    world.ecs_flush();
+    
+    ComponentArray<TestComponent> components;
+    for (int i = 0; i < count; ++i) {
+        components.InsertData(static_cast<EntityID>(i + 1), TestComponent(i));
+    }
+    ParallelEach(jobSystem, components, [](EntityID entity, TestComponent& component) {
+        component.SetValue(component.GetValue() + 1);
+    }, 100);
+    
+    for (int i = 0; i < count; ++i) {
+        ASSERT_EQ(components.GetData(static_cast<EntityID>(i + 1)).GetValue(), i + 1);
+    }
+    
+    ASSERT_EQ(JobSystem::CacheAlignedGrain<TestComponent>(100) % (JobSystem::CACHE_LINE_SIZE / sizeof(TestComponent)), 0);
+    
+    // sizes that don't divide a line: 20-byte elements need 16 per range to end on a line,
+    // and a group's ranges must do so in every owned array at once
+    struct Twenty { char bytes[20]; };
+    struct Twelve { char bytes[12]; };
+    ASSERT_EQ(JobSystem::CacheAlignedGrain<Twenty>(1), 16u);
+    ASSERT_EQ(JobSystem::CacheAlignedGrain<Twenty>(100) * sizeof(Twenty) % JobSystem::CACHE_LINE_SIZE, 0u);
+    ASSERT_EQ((JobSystem::CacheAlignedGrain<Twenty, Twelve, std::uint64_t>(1)), 16u);
+    ASSERT_EQ(JobSystem::CacheAlignedGrain<std::uint64_t>(9), 16u);
+    
+    world.Group<TestComponent, OtherTestComponent>().ParallelEach(jobSystem,
+        [](Entity entity, TestComponent& test, OtherTestComponent& other) {
+            other.value = static_cast<float>(test.GetValue());
+        }, 64);
+    
+    std::atomic<int> visited(0);
+    world.View<const TestComponent, const OtherTestComponent>().ParallelEach(jobSystem,
+        [&](Entity entity, const TestComponent& test, const OtherTestComponent& other) {
+            if (static_cast<float>(test.GetValue()) == other.value) {
+                ++visited;
+            }
+        }, 64);
+    ASSERT_EQ(visited.load(), count / 2);
+    
+    return true;
+}
+
+bool TestThreadCommandBuffers() {
+    JobSystem jobSystem(3);
+    World world;
+    world.SetJobSystem(&jobSystem);
+    
+    auto existing = world.CreateEntity();
+    
+    // workers reserve entities and queue components without any shared lock
+    const size_t count = 2000;
+    std::vector<Entity> spawned(count);
+    jobSystem.ParallelFor(count, 64, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            spawned[i] = world.ReserveEntity();
+            world.AddComponent<TestComponent>(spawned[i], TestComponent(static_cast<int>(i)));
+        }
+    });
+    
+    ASSERT_EQ(world.GetPendingOperationCount(), count);
+    ASSERT_FALSE(world.IsEntityValid(spawned[0]));
+    
+    // a fresh CreateEntity must not collide with reserved IDs
+    auto created = world.CreateEntity();
+    ASSERT_EQ(world.GetEntityCount(), count + 2);
+    
+    world.AddComponent<OtherTestComponent>(created, OtherTestComponent(1.0f));
+    world.ecs_flush();
+    
+    ASSERT_EQ(world.GetPendingOperationCount(), 0);
+    for (size_t i = 0; i < count; ++i) {
+        ASSERT_TRUE(world.IsEntityValid(spawned[i]));
+        ASSERT_NE(spawned[i].GetID(), created.GetID());
+        ASSERT_NE(spawned[i].GetID(), existing.GetID());
+        ASSERT_EQ(world.GetComponent<TestComponent>(spawned[i]).GetValue(), static_cast<int>(i));
+    }
+    ASSERT_TRUE(world.HasComponent<OtherTestComponent>(created));
+    
+    // a batch taken after a reservation materializes the reserved slot with it
+    Entity reserved = world.ReserveEntity();
+    std::vector<Entity> batch(3);
+    world.CreateEntities(batch.size(), batch);
+    ASSERT_EQ(batch[0].GetID(), reserved.GetID() + 1);
+    ASSERT_TRUE(world.IsEntityValid(reserved));
+    ASSERT_EQ(world.GetEntityCount(), count + 6);
+    world.ecs_flush();
+    ASSERT_EQ(world.GetEntityCount(), count + 6);
+    
+    // systems running side by side must reserve rather than create
+    auto spawner = world.RegisterSystem<SpawningTestSystem>();
+    spawner->world = &world;
+    spawner->prefab.Set(OtherTestComponent(1.0f));
+    world.RegisterSystem<FixedStepTestSystem>();
+    ASSERT_EQ(world.GetScheduleStageCount(), 1u);
+    world.Update(0.016f);
+    ASSERT_TRUE(spawner->createThrew);
+    ASSERT_TRUE(spawner->instantiateThrew);
+    world.ecs_flush();
+    ASSERT_TRUE(world.IsEntityValid(spawner->reserved));
+    ASSERT_EQ(world.GetEntityCount(), count + 7);
+    
+    return true;
+}
+
+struct CommandMergeResult {
+    int targetValue = -1;
+    std::vector<EntityID> systemOrder;
+    std::vector<int> values;
+};
+
+// 64 single-element ranges queue conflicting commands; seed varies how long each range takes,
+// which moves ranges between threads from one run to the next
+CommandMergeResult RunConflictingCommands(JobSystem& jobSystem, int seed, std::vector<std::size_t>* threads) {
+    World world;
+    world.SetJobSystem(&jobSystem);
+    auto system = world.RegisterSystem<OtherTestSystem>();
+    Signature signature;
+    signature.set(ComponentTypeRegistry::GetTypeID<OtherTestComponent>());
+    world.SetSystemSignature<OtherTestSystem>(signature);
+    
+    Entity target = world.CreateEntity();
+    std::vector<Entity> entities(64);
+    world.CreateEntities(entities.size(), entities);
+    if (threads) {
+        threads->assign(entities.size(), 0);
+    }
+    
+    jobSystem.ParallelFor(entities.size(), 1, [&](size_t begin, size_t end) {
+        for (size_t r = begin; r < end; ++r) {
+            auto spinUntil = std::chrono::steady_clock::now() + std::chrono::microseconds(((r * 7 + seed * 13) % 5) * 40);
+            while (std::chrono::steady_clock::now() < spinUntil) {}
+            if (threads) {
+                (*threads)[r] = jobSystem.GetThreadIndex();
+            }
+            
+            int value = static_cast<int>(r);
+            if (r % 4 == 1) {
+                world.RemoveComponent<TestComponent>(target);
+            } else {
+                world.AddComponent(target, TestComponent(value));
+            }
+            
+            world.AddComponent(entities[r], TestComponent(value));
+            if (r % 2 == 1) {
+                world.RemoveComponent<TestComponent>(entities[r]);
+                world.AddComponent(entities[r], TestComponent(value * 10));
+            }
+            world.AddComponent(entities[r], OtherTestComponent(static_cast<float>(value)));
+        }
+    });
+    world.ecs_flush();
+    
+    CommandMergeResult result;
+    if (world.HasComponent<TestComponent>(target)) {
+        result.targetValue = world.GetComponent<TestComponent>(target).GetValue();
+    }
+    for (Entity entity : system->GetEntities()) {
+        result.systemOrder.push_back(entity.GetID());
+    }
+    for (Entity entity : entities) {
+        result.values.push_back(world.GetComponent<TestComponent>(entity).GetValue());
+    }
+    return result;
+}
+
+bool TestDeterministicCommands() {
+    // the serial run is the reference: no workers, every range inline in order
+    JobSystem serial(0);
+    CommandMergeResult expected = RunConflictingCommands(serial, 0, nullptr);
+    ASSERT_EQ(expected.targetValue, 63);
+    ASSERT_EQ(expected.systemOrder.size(), 64u);
+    ASSERT_EQ(expected.values[3], 30);
+    ASSERT_EQ(expected.values[4], 4);
+    
+    JobSystem jobSystem(3);
+    bool spread = false;
+    for (int seed = 0; seed < 12; ++seed) {
+        std::vector<std::size_t> threads;
+        CommandMergeResult result = RunConflictingCommands(jobSystem, seed, &threads);
+        ASSERT_EQ(result.targetValue, expected.targetValue);
+        ASSERT_TRUE(result.systemOrder == expected.systemOrder);
+        ASSERT_TRUE(result.values == expected.values);
+        spread = spread || std::any_of(threads.begin(), threads.end(), [&](std::size_t index) { return index != threads[0]; });
+    }
+    // the ranges really did run on more than one thread
+    ASSERT_TRUE(spread);
+    
+    // commands queued from inside systems merge by stage order, ahead of later main-thread ones
+    World world;
+    world.SetJobSystem(&jobSystem);
+    Entity entity = world.CreateEntity();
+    auto spawner = world.RegisterSystem<SpawningTestSystem>();
+    spawner->world = &world;
+    world.RegisterSystem<FixedStepTestSystem>();
+    world.Update(0.016f);
+    world.AddComponent(spawner->reserved, TestComponent(1));
+    world.RemoveComponent<TestComponent>(spawner->reserved);
+    world.AddComponent(entity, TestComponent(2));
+    world.ecs_flush();
+    ASSERT_FALSE(world.HasComponent<TestComponent>(spawner->reserved));
+    ASSERT_EQ(world.GetComponent<TestComponent>(entity).GetValue(), 2);
+    
+    return true;
+}
+
+bool TestBulkEntities() {
+    World world;
+    auto system = world.RegisterSystem<TestSystem>();
+    
+    Signature signature;
+    signature.set(ComponentTypeRegistry::GetTypeID<TestComponent>());
+    world.SetSystemSignature<TestSystem>(signature);
+    
+    auto single = world.CreateEntity();
+    world.DestroyEntity(single);
+    
+    std::vector<Entity> entities(1000);
+    world.CreateEntities(entities.size(), entities);
+    
+    ASSERT_EQ(world.GetEntityCount(), 1000);
+    for (size_t i = 1; i < entities.size(); ++i) {
+        ASSERT_EQ(entities[i].GetID(), entities[0].GetID() + i);
+    }
+    
+    world.AddComponents(Span<const Entity>(entities), TestComponent(7));
+    ASSERT_EQ(world.GetPendingOperationCount(), 1000);
+    world.ecs_flush();
+    
+    ASSERT_EQ(system->addedCount, 1000);
+    ASSERT_EQ(world.GetComponent<TestComponent>(entities[500]).GetValue(), 7);
+    
+    // duplicates and stale handles in the batch are ignored
+    std::vector<Entity> doomed(entities.begin(), entities.begin() + 600);
+    doomed.push_back(entities[0]);
+    doomed.push_back(single);
+    world.DestroyEntities(doomed);
+    
+    ASSERT_EQ(world.GetEntityCount(), 400);
+    ASSERT_EQ(system->removedCount, 600);
+    ASSERT_EQ(system->GetEntityCount(), 400);
+    ASSERT_FALSE(world.IsEntityValid(entities[0]));
+    ASSERT_EQ(world.GetComponent<TestComponent>(entities[999]).GetValue(), 7);
+    
+    // a batch destroyed together comes back as one contiguous run of its old slots
+    std::vector<Entity> refill(600);
+    world.CreateEntities(refill.size(), refill);
+    ASSERT_EQ(world.GetEntityCount(), 1000);
+    for (size_t i = 0; i < refill.size(); ++i) {
+        ASSERT_EQ(refill[i].GetID(), entities[i].GetID());
+        ASSERT_FALSE(world.IsEntityValid(entities[i]));
+        ASSERT_TRUE(world.IsEntityValid(refill[i]));
+        ASSERT_FALSE(world.HasComponent<TestComponent>(refill[i]));
+    }
+    
+    // create/destroy waves keep landing in the same slots instead of growing the tables
+    // (the first wave needs 300 fresh slots on top of the 600 free ones, later waves none)
+    world.DestroyEntities(refill);
+    EntityID highest = 0;
+    std::vector<Entity> wave(900);
+    for (int round = 0; round < 10; ++round) {
+        world.CreateEntities(wave.size(), wave);
+        for (Entity entity : wave) {
+            highest = std::max(highest, entity.GetID());
+        }
+        world.DestroyEntities(wave);
+    }
+    ASSERT_EQ(world.GetEntityCount(), 400);
+    ASSERT_EQ(highest, 1300u);
+    
+    return true;
+}
+
+bool TestPrefabInstantiate() {
+    for (ComponentStorage storage : { ComponentStorage::SparseSet, ComponentStorage::Archetype }) {
+        World world(storage);
+        auto system = world.RegisterSystem<TestSystem>();
+        
+        Signature signature;
+        signature.set(ComponentTypeRegistry::GetTypeID<TestComponent>());
+        world.SetSystemSignature<TestSystem>(signature);
+        
+        Prefab prefab;
+        prefab.Set(TestComponent(5)).Set(OtherTestComponent(2.5f));
+        prefab.Set(TestComponent(6));
+        ASSERT_EQ(prefab.GetComponentCount(), 2);
+        
+        std::vector<Entity> entities(100);
+        world.Instantiate(prefab, entities.size(), entities);
+        
+        // applied immediately, without a flush
+        ASSERT_EQ(world.GetPendingOperationCount(), 0);
+        ASSERT_EQ(world.GetEntityCount(), 100);
+        ASSERT_EQ(system->GetEntityCount(), 100);
+        
+        world.GetComponent<TestComponent>(entities[0]).SetValue(1);
+        ASSERT_EQ(world.GetComponent<TestComponent>(entities[0]).GetValue(), 1);
+        ASSERT_EQ(world.GetComponent<TestComponent>(entities[99]).GetValue(), 6);
+        ASSERT_EQ(world.GetComponent<OtherTestComponent>(entities[50]).value, 2.5f);
+        ASSERT_EQ(prefab.Get<TestComponent>().GetValue(), 6);
+        
+        auto single = world.Instantiate(prefab);
+        ASSERT_TRUE(world.HasComponent<OtherTestComponent>(single));
+        
+        // instances reuse destroyed slots and start from the prefab, not the old components
+        world.DestroyEntities(entities);
+        world.Instantiate(prefab, entities.size(), entities);
+        ASSERT_EQ(world.GetEntityCount(), 101);
+        ASSERT_EQ(system->GetEntityCount(), 101);
+        for (Entity entity : entities) {
+            ASSERT_TRUE(entity.GetID() <= 101);
+        }
+        ASSERT_EQ(world.GetComponent<TestComponent>(entities[0]).GetValue(), 6);
+    }
+    
+    return true;
+}
+
+bool TestPointerStableStorage() {
+    World world;
+    auto first = world.CreateEntity();
+    world.AddComponent(first, StableTestComponent(42));
+    world.ecs_flush();
+    
+    StableTestComponent* pointer = &world.GetComponent<StableTestComponent>(first);
+    
+    // growing across many pages must not move the existing component
+    std::vector<Entity> others(1000);
+    world.CreateEntities(others.size(), others);
+    world.AddComponents(Span<const Entity>(others), StableTestComponent(1));
+    world.ecs_flush();
+    
+    ASSERT_EQ(&world.GetComponent<StableTestComponent>(first), pointer);
+    ASSERT_EQ(pointer->value, 42);
+    
+    world.DestroyEntity(others[10]);
+    ASSERT_EQ(world.GetComponent<StableTestComponent>(others[999]).value, 1);
+    ASSERT_EQ(&world.GetComponent<StableTestComponent>(first), pointer);
+    
+    return true;
+}
+
+bool TestPodComponents() {
+    // no vtable pointer: the component is exactly its fields
+    static_assert(sizeof(PodTestComponent) == sizeof(int) + sizeof(float), "POD component carries a vtable");
+    static_assert(IsComponent_v<PodTestComponent>, "opted-in POD should be a component");
+    ASSERT_TRUE(ComponentTypeInfo::Of<PodTestComponent>().triviallyCopyable);
+    
+    World world;
+    std::vector<Entity> entities(4);
+    world.CreateEntities(entities.size(), entities);
+    for (int i = 0; i < 4; ++i) {
+        world.AddComponent(entities[i], PodTestComponent{ i, i * 0.5f });
+    }
+    world.ecs_flush();
+    
+    // swap-remove moves the last element into the hole
+    world.RemoveComponent<PodTestComponent>(entities[1]);
+    world.ecs_flush();
+    ASSERT_FALSE(world.HasComponent<PodTestComponent>(entities[1]));
+    ASSERT_EQ(world.GetComponent<PodTestComponent>(entities[3]).value, 3);
+    ASSERT_EQ(world.GetComponent<PodTestComponent>(entities[3]).weight, 1.5f);
+    
+    int sum = 0;
+    world.View<PodTestComponent>().Each([&](Entity, PodTestComponent& component) { sum += component.value; });
+    ASSERT_EQ(sum, 0 + 2 + 3);
+    
+    // removing the last element has nothing to move into the hole
+    world.RemoveComponent<PodTestComponent>(entities[2]);
+    world.ecs_flush();
+    ASSERT_FALSE(world.HasComponent<PodTestComponent>(entities[2]));
+    ASSERT_EQ(world.GetComponent<PodTestComponent>(entities[3]).value, 3);
+    ASSERT_EQ(world.GetComponent<PodTestComponent>(entities[0]).value, 0);
+    
+    World archetypeWorld(ComponentStorage::Archetype);
+    Prefab prefab;
+    prefab.Set(PodTestComponent{ 7, 2.0f }).Set(TestComponent(1));
+    std::vector<Entity> instances(3);
+    archetypeWorld.Instantiate(prefab, instances.size(), instances);
+    archetypeWorld.ecs_flush();
+    archetypeWorld.DestroyEntity(instances[0]);
+    ASSERT_EQ(archetypeWorld.GetComponent<PodTestComponent>(instances[2]).value, 7);
+    ASSERT_EQ(archetypeWorld.GetComponent<PodTestComponent>(instances[2]).weight, 2.0f);
+    
+    return true;
+}
+
+bool TestChangeDetection() {
+    World world;
+    auto watcher = world.RegisterSystem<ChangeWatchSystem>();
+    watcher->world = &world;
+    
+    std::vector<Entity> entities(4);
+    world.CreateEntities(entities.size(), entities);
+    world.AddComponents(Span<const Entity>(entities), TestComponent(1));
+    world.ecs_flush();
+    
+    // everything is new on the first run, nothing on the second
+    world.Update(0.0f);
+    ASSERT_EQ(watcher->changed, 4);
+    world.Update(0.0f);
+    ASSERT_EQ(watcher->changed, 0);
+    
+    // plain reads and const views leave ticks alone; GetMut stamps
+    world.GetComponent<TestComponent>(entities[0]);
+    world.View<const TestComponent>().Each([](Entity, const TestComponent&) {});
+    world.GetMut<TestComponent>(entities[2]).SetValue(5);
+    ASSERT_TRUE(world.HasChangedSince<TestComponent>(entities[2], watcher->GetLastRunTick()));
+    ASSERT_FALSE(world.HasChangedSince<TestComponent>(entities[0], watcher->GetLastRunTick()));
+    world.Update(0.0f);
+    ASSERT_EQ(watcher->changed, 1);
+    
+    // a mutable view stamps every element it hands out
+    world.View<TestComponent>().Each([](Entity, TestComponent&) {});
+    world.Update(0.0f);
+    ASSERT_EQ(watcher->changed, 4);
+    
+    // ticks follow their elements through swap-removal
+    Tick closed = world.AdvanceTick();
+    world.GetMut<TestComponent>(entities[3]);
+    world.RemoveComponent<TestComponent>(entities[0]);
+    world.ecs_flush();
+    ASSERT_TRUE(world.HasChangedSince<TestComponent>(entities[3], closed));
+    ASSERT_FALSE(world.HasChangedSince<TestComponent>(entities[1], closed));
+    
+    return true;
+}
+
+bool TestBatchedObservers() {
+    World world;
+    auto batchSystem = world.RegisterSystem<BatchTestSystem>();
+    auto perEntitySystem = world.RegisterSystem<TestSystem>();
+    Signature signature;
+    signature.set(ComponentTypeRegistry::GetTypeID<TestComponent>());
+    world.SetSystemSignature<BatchTestSystem>(signature);
+    world.SetSystemSignature<TestSystem>(signature);
+    
+    std::vector<size_t> constructed;
+    std::vector<size_t> destroyed;
+    bool destroyedStillHave = false;
+    world.OnConstruct<TestComponent>([&](Span<const Entity> entities) { constructed.push_back(entities.size()); });
+    world.OnDestroy<TestComponent>([&](Span<const Entity> entities) {
+        destroyed.push_back(entities.size());
+        for (Entity entity : entities) {
+            destroyedStillHave |= world.HasComponent<TestComponent>(entity);
+        }
+    });
+    
+    std::vector<Entity> entities(5);
+    world.CreateEntities(entities.size(), entities);
+    world.AddComponents(Span<const Entity>(entities), TestComponent(1));
+    world.ecs_flush();
+    
+    // one span per flush for the batched system; the default still reaches per-entity hooks
+    ASSERT_EQ(batchSystem->addedBatches.size(), 1u);
+    ASSERT_EQ(batchSystem->addedBatches[0], 5u);
+    ASSERT_EQ(perEntitySystem->addedCount, 5);
+    ASSERT_EQ(constructed.size(), 1u);
+    ASSERT_EQ(constructed[0], 5u);
+    
+    // replacing an existing component is not a construction
+    world.AddComponent(entities[0], TestComponent(2));
+    world.RemoveComponent<TestComponent>(entities[1]);
+    world.RemoveComponent<TestComponent>(entities[2]);
+    world.ecs_flush();
+    ASSERT_EQ(constructed.size(), 1u);
+    ASSERT_EQ(batchSystem->removedBatches.size(), 1u);
+    ASSERT_EQ(batchSystem->removedBatches[0], 2u);
+    ASSERT_EQ(destroyed.size(), 1u);
+    ASSERT_EQ(destroyed[0], 2u);
+    
+    world.DestroyEntities(Span<const Entity>(entities.data() + 3, 2));
+    ASSERT_EQ(batchSystem->removedBatches.size(), 2u);
+    ASSERT_EQ(batchSystem->removedBatches[1], 2u);
+    ASSERT_EQ(perEntitySystem->removedCount, 4);
+    ASSERT_EQ(destroyed.size(), 2u);
+    ASSERT_EQ(destroyed[1], 2u);
+    ASSERT_FALSE(destroyedStillHave);
+    
+    Prefab prefab;
+    prefab.Set(TestComponent(3));
+    std::vector<Entity> instances(4);
+    world.Instantiate(prefab, instances.size(), instances);
+    ASSERT_EQ(batchSystem->addedBatches.size(), 2u);
+    ASSERT_EQ(batchSystem->addedBatches[1], 4u);
+    ASSERT_EQ(constructed.size(), 2u);
+    ASSERT_EQ(constructed[1], 4u);
+    
+    return true;
+}
+
+bool TestArraySorting() {
+    World world;
+    std::vector<Entity> entities(64);
+    world.CreateEntities(entities.size(), entities);
+    for (size_t i = 0; i < entities.size(); ++i) {
+        int value = static_cast<int>((i * 37) % entities.size());
+        world.AddComponent(entities[i], TestComponent(value));
+        world.AddComponent(entities[entities.size() - 1 - i], OtherTestComponent(static_cast<float>(i)));
+    }
+    world.ecs_flush();
+    
+    world.Sort<TestComponent>([](const TestComponent& a, const TestComponent& b) { return a.GetValue() < b.GetValue(); });
+    
+    int previous = -1;
+    bool ordered = true;
+    world.View<const TestComponent>().Each([&](Entity, const TestComponent& component) {
+        ordered &= component.GetValue() > previous;
+        previous = component.GetValue();
+    });
+    ASSERT_TRUE(ordered);
+    ASSERT_EQ(world.GetComponent<TestComponent>(entities[1]).GetValue(), 37);
+    
+    // after aligning, both arrays list the shared entities in the same dense order
+    auto aligned = [&]() {
+        std::vector<Entity> first;
+        std::vector<Entity> second;
+        world.View<const TestComponent>().Each([&](Entity entity, const TestComponent&) { first.push_back(entity); });
+        world.View<const OtherTestComponent>().Each([&](Entity entity, const OtherTestComponent&) { second.push_back(entity); });
+        return first == second;
+    };
+    ASSERT_FALSE(aligned());
+    world.AlignTo<TestComponent, OtherTestComponent>();
+    ASSERT_TRUE(aligned());
+    
+    // churn scrambles the order again; a small per-update budget restores it over a few frames
+    world.DestroyEntities(Span<const Entity>(entities.data(), 8));
+    world.Sort<TestComponent>([](const TestComponent& a, const TestComponent& b) { return a.GetValue() > b.GetValue(); });
+    ASSERT_FALSE(aligned());
+    world.EnableDefragmentation<TestComponent, OtherTestComponent>();
+    world.SetDefragmentationBudget(16);
+    for (int frame = 0; frame < 4; ++frame) {
+        world.Update(0.0f);
+    }
+    ASSERT_TRUE(aligned());
+    
+    bool threw = false;
+    world.Group<TestComponent>();
+    try {
+        world.Sort<TestComponent>([](const TestComponent& a, const TestComponent& b) { return a.GetValue() < b.GetValue(); });
+    } catch (const std::runtime_error&) {
+        threw = true;
+    }
+    ASSERT_TRUE(threw);
+    
+    return true;
+}
+
+bool TestTransformHierarchy() {
+    World world;
+    auto hierarchy = world.RegisterSystem<TransformHierarchySystem>();
+    hierarchy->SetWorld(&world);
+    
+    Signature signature;
+    signature.set(ComponentTypeRegistry::GetTypeID<Transform2D>());
+    signature.set(ComponentTypeRegistry::GetTypeID<WorldTransform2D>());
+    world.SetSystemSignature<TransformHierarchySystem>(signature);
+    
+    Entity root = world.CreateEntity();
+    Entity child = world.CreateEntity();
+    Entity grandchild = world.CreateEntity();
+    Entity other = world.CreateEntity();
+    
+    world.AddComponent(root, Transform2D(glm::vec2(10.0f, 0.0f), glm::vec2(2.0f)));
+    world.AddComponent(child, Transform2D(glm::vec2(1.0f, 0.0f)));
+    world.AddComponent(grandchild, Transform2D(glm::vec2(0.0f, 1.0f)));
+    world.AddComponent(other, Transform2D(glm::vec2(-5.0f, 0.0f)));
+    for (Entity entity : { root, child, grandchild, other }) {
+        world.AddComponent(entity, WorldTransform2D());
+    }
+    world.AddComponent(child, Parent(root));
+    world.AddComponent(grandchild, Parent(child));
+    world.ecs_flush();
+    
+    auto position = [&](Entity entity) { return world.GetComponent<WorldTransform2D>(entity).GetPosition(); };
+    auto near = [](float a, float b) { return std::abs(a - b) < 1e-4f; };
+    
+    world.Update(0.0f);
+    ASSERT_EQ(hierarchy->GetRootCount(), 2u);
+    ASSERT_EQ(hierarchy->GetNodeCount(), 4u);
+    ASSERT_TRUE(near(position(child).x, 12.0f));
+    ASSERT_TRUE(near(position(grandchild).x, 12.0f));
+    ASSERT_TRUE(near(position(grandchild).y, 2.0f));
+    
+    // only the moved root's subtree is rewritten
+    Tick before = world.AdvanceTick();
+    world.GetMut<Transform2D>(root).rotation = 90.0f;
+    world.Update(0.0f);
+    ASSERT_TRUE(near(position(child).x, 10.0f));
+    ASSERT_TRUE(near(position(child).y, 2.0f));
+    ASSERT_TRUE(near(position(grandchild).x, 8.0f));
+    ASSERT_TRUE(world.HasChangedSince<WorldTransform2D>(grandchild, before));
+    ASSERT_FALSE(world.HasChangedSince<WorldTransform2D>(other, before));
+    
+    // a moved leaf rewrites only itself, not the clean ancestors it is composed with
+    before = world.AdvanceTick();
+    world.GetMut<Transform2D>(grandchild).position.y = 2.0f;
+    world.Update(0.0f);
+    ASSERT_TRUE(near(position(grandchild).x, 6.0f));
+    ASSERT_TRUE(near(position(grandchild).y, 2.0f));
+    ASSERT_TRUE(world.HasChangedSince<WorldTransform2D>(grandchild, before));
+    ASSERT_FALSE(world.HasChangedSince<WorldTransform2D>(child, before));
+    ASSERT_FALSE(world.HasChangedSince<WorldTransform2D>(root, before));
+    
+    // with nothing moved, nothing is rewritten
+    before = world.AdvanceTick();
+    world.Update(0.0f);
+    for (Entity entity : { root, child, grandchild, other }) {
+        ASSERT_FALSE(world.HasChangedSince<WorldTransform2D>(entity, before));
+    }
+    world.GetMut<Transform2D>(grandchild).position.y = 1.0f;
+    world.Update(0.0f);
+    ASSERT_TRUE(near(position(grandchild).x, 8.0f));
+    
+    // reparenting and unparenting rebuild the order
+    world.GetMut<Parent>(child).entity = other;
+    world.Update(0.0f);
+    ASSERT_TRUE(near(position(grandchild).x, -4.0f));
+    ASSERT_TRUE(near(position(grandchild).y, 1.0f));
+    
+    world.RemoveComponent<Parent>(child);
+    world.ecs_flush();
+    world.Update(0.0f);
+    ASSERT_EQ(hierarchy->GetRootCount(), 3u);
+    ASSERT_TRUE(near(position(grandchild).x, 1.0f));
+    
+    // a child whose parent is destroyed becomes a root
+    world.DestroyEntity(child);
+    world.Update(0.0f);
+    ASSERT_EQ(hierarchy->GetNodeCount(), 3u);
+    ASSERT_TRUE(near(position(grandchild).x, 0.0f));
+    
+    return true;
+}
+
+bool TestWorldSnapshot() {
+    std::stringstream stream;
+    std::vector<Entity> entities(6);
+    
+    {
+        World world;
+        world.CreateEntities(entities.size(), entities);
+        for (size_t i = 0; i < entities.size(); ++i) {
+            world.AddComponent(entities[i], PodTestComponent{ static_cast<int>(i), 0.5f * i });
+            world.AddComponent(entities[i], TestComponent(static_cast<int>(i)));
+        }
+        world.ecs_flush();
+        world.DestroyEntity(entities[2]);
+        world.SaveSnapshot(stream);
+    }
+    
+    World world;
+    world.RegisterComponent<PodTestComponent>();
+    auto system = world.RegisterSystem<BatchTestSystem>();
+    Signature signature;
+    signature.set(ComponentTypeRegistry::GetTypeID<PodTestComponent>());
+    world.SetSystemSignature<BatchTestSystem>(signature);
+    
+    std::vector<Entity> preexisting(entities.size() + 1);
+    world.CreateEntities(preexisting.size(), preexisting);
+    world.AddComponents<PodTestComponent>(preexisting, PodTestComponent{ 99, 0.0f });
+    world.ecs_flush();
+    
+    world.LoadSnapshot(stream);
+    
+    // handles from the saved World stay valid, including the destroyed one being stale
+    ASSERT_EQ(world.GetEntityCount(), 5u);
+    ASSERT_FALSE(world.IsEntityValid(entities[2]));
+    ASSERT_TRUE(world.IsEntityValid(entities[5]));
+    ASSERT_EQ(world.GetComponent<PodTestComponent>(entities[4]).value, 4);
+    ASSERT_TRUE(world.GetComponent<PodTestComponent>(entities[5]).weight == 2.5f);
+    ASSERT_FALSE(world.IsEntityValid(preexisting.back()));
+    ASSERT_EQ(world.GetComponent<PodTestComponent>(preexisting[0]).value, 0);
+    
+    // TestComponent is not trivially copyable, so it is not part of the snapshot
+    ASSERT_FALSE(world.HasComponent<TestComponent>(entities[0]));
+    
+    ASSERT_EQ(system->GetEntityCount(), 5u);
+    ASSERT_EQ(system->addedBatches.back(), 5u);
+    
+    // the free list comes back too, so the destroyed slot is reused next
+    Entity reused = world.CreateEntity();
+    ASSERT_EQ(reused.GetID(), entities[2].GetID());
+    
+    bool threw = false;
+    std::stringstream garbage("not a snapshot at all");
+    try {
+        world.LoadSnapshot(garbage);
+    } catch (const std::runtime_error&) {
+        threw = true;
+    }
+    ASSERT_TRUE(threw);
+    ASSERT_EQ(world.GetEntityCount(), 6u);
+    
+    // a free list naming a live slot, a slot out of range or one slot twice is rejected
+    // before the World changes; it follows the header and generations[7]
+    const size_t freeListOffset = 6 * sizeof(std::uint32_t) + 7 * sizeof(EntityGeneration);
+    for (EntityID corrupt : { entities[0].GetID(), EntityID(100), EntityID(0) }) {
+        std::string bytes = stream.str();
+        std::memcpy(&bytes[freeListOffset], &corrupt, sizeof(EntityID));
+        std::stringstream corrupted(bytes);
+        threw = false;
+        try {
+            world.LoadSnapshot(corrupted);
+        } catch (const std::runtime_error&) {
+            threw = true;
+        }
+        ASSERT_TRUE(threw);
+        ASSERT_EQ(world.GetEntityCount(), 6u);
+        ASSERT_TRUE(world.IsEntityValid(reused));
+    }
+    
+    // columns are keyed by a compiler-independent name, not the RTTI one
+    ASSERT_TRUE(ComponentName<PodTestComponent>::value == "PodTestComponent");
+    ASSERT_TRUE(ComponentName<TestComponent>::value == "UniversalEngine::TestComponent");
+    
+    return true;
+}
+
+bool TestRollback() {
+    World world;
+    world.EnableRollback<PodTestComponent>(4);
+    auto system = world.RegisterSystem<TestSystem>();
+    Signature signature;
+    signature.set(ComponentTypeRegistry::GetTypeID<PodTestComponent>());
+    world.SetSystemSignature<TestSystem>(signature);
+    
+    std::vector<Entity> entities(3);
+    world.CreateEntities(entities.size(), entities);
+    for (size_t i = 0; i < entities.size(); ++i) {
+        world.AddComponent(entities[i], PodTestComponent{ static_cast<int>(i), 0.0f });
+    }
+    world.ecs_flush();
+    world.RecordFrame();
+    
+    // frame 1: a value changes and an entity is destroyed
+    world.GetComponent<PodTestComponent>(entities[0]).value = 10;
+    world.DestroyEntity(entities[1]);
+    world.RecordFrame();
+    
+    // frame 2: a new entity, with a component rollback does not track
+    Entity spawned = world.CreateEntity();
+    world.AddComponent(spawned, PodTestComponent{ 7, 0.0f });
+    world.AddComponent(spawned, TestComponent(7));
+    world.ecs_flush();
+    world.RecordFrame();
+    ASSERT_EQ(world.GetRecordedFrameCount(), 3u);
+    ASSERT_EQ(spawned.GetID(), entities[1].GetID());
+    
+    // unrecorded changes are discarded by Rewind(0)
+    world.GetComponent<PodTestComponent>(spawned).value = 8;
+    world.Rewind(0);
+    ASSERT_EQ(world.GetComponent<PodTestComponent>(spawned).value, 7);
+    
+    world.Rewind(2);
+    ASSERT_EQ(world.GetRecordedFrameCount(), 1u);
+    ASSERT_FALSE(world.IsEntityValid(spawned));
+    ASSERT_TRUE(world.IsEntityValid(entities[1]));
+    ASSERT_EQ(world.GetComponent<PodTestComponent>(entities[0]).value, 0);
+    ASSERT_EQ(world.GetComponent<PodTestComponent>(entities[1]).value, 1);
+    ASSERT_EQ(world.GetEntityCount(), 3u);
+    ASSERT_EQ(system->GetEntityCount(), 3u);
+    ASSERT_TRUE(system->HasEntity(entities[1]));
+    
+    // re-simulate from the restored frame, down a different path
+    world.GetComponent<PodTestComponent>(entities[2]).value = 20;
+    world.RecordFrame();
+    ASSERT_EQ(world.GetRecordedFrameCount(), 2u);
+    world.Rewind(1);
+    ASSERT_EQ(world.GetComponent<PodTestComponent>(entities[2]).value, 2);
+    
+    // the ring only keeps the last four frames
+    for (int frame = 0; frame < 6; ++frame) {
+        world.GetComponent<PodTestComponent>(entities[0]).value = 100 + frame;
+        world.RecordFrame();
+    }
+    ASSERT_EQ(world.GetRecordedFrameCount(), 4u);
+    world.Rewind(3);
+    ASSERT_EQ(world.GetComponent<PodTestComponent>(entities[0]).value, 102);
+    
+    bool threw = false;
+    try {
+        world.Rewind(1);
+    } catch (const std::runtime_error&) {
+        threw = true;
+    }
+    ASSERT_TRUE(threw);
+    
+    // history recorded before a snapshot load does not describe the loaded World
+    std::stringstream stream;
+    world.SaveSnapshot(stream);
+    world.RecordFrame();
+    world.LoadSnapshot(stream);
+    ASSERT_EQ(world.GetRecordedFrameCount(), 0u);
+    world.RecordFrame();
+    world.GetComponent<PodTestComponent>(entities[0]).value = -1;
+    world.Rewind(0);
+    ASSERT_EQ(world.GetComponent<PodTestComponent>(entities[0]).value, 102);
+    
+    return true;
+}
+
+bool TestFixedTimestep() {
+    FixedTimestep timestep(0.25f, 4);
+    
+    ASSERT_EQ(timestep.Advance(0.125f), 0);
+    ASSERT_EQ(timestep.GetAlpha(), 0.5f);
+    ASSERT_EQ(timestep.Advance(0.625f), 3);
+    ASSERT_EQ(timestep.GetAlpha(), 0.0f);
+    ASSERT_EQ(timestep.Advance(0.375f), 1);
+    ASSERT_EQ(timestep.GetAlpha(), 0.5f);
+    
+    // a hitch runs the maximum and drops the rest instead of carrying it into later frames
+    ASSERT_EQ(timestep.Advance(10.0f), 4);
+    ASSERT_TRUE(timestep.GetAlpha() < 1.0f);
+    timestep.Reset();
+    ASSERT_EQ(timestep.Advance(0.25f), 1);
+    
+    // World::FixedUpdate drives FixedUpdate(), not Update(), on the same schedule
+    JobSystem jobSystem(2);
+    World world;
+    world.SetJobSystem(&jobSystem);
+    auto system = world.RegisterSystem<FixedStepTestSystem>();
+    auto other = world.RegisterSystem<OtherFixedStepTestSystem>();
+    ASSERT_EQ(world.GetScheduleStageCount(), 1u);
+    
+    for (int frame = 0; frame < 3; ++frame) {
+        int steps = timestep.Advance(0.5f);
+        for (int step = 0; step < steps; ++step) {
+            world.FixedUpdate(timestep.GetStep());
+        }
+        world.Update(0.5f);
+    }
+    ASSERT_EQ(system->steps.load(), 6);
+    ASSERT_EQ(other->steps.load(), 6);
+    ASSERT_EQ(system->simulated, 1.5f);
+    
+    // each step closes a tick per stage, so sub-steps of one frame stamp distinct ticks
+    Tick before = world.GetTick();
+    world.FixedUpdate(timestep.GetStep());
+    ASSERT_EQ(world.GetTick(), before + 1);
+    ASSERT_EQ(system->steps.load(), 7);
+    
+    system->SetEnabled(false);
+    world.FixedUpdate(timestep.GetStep());
+    ASSERT_EQ(system->steps.load(), 7);
+    ASSERT_EQ(other->steps.load(), 8);
+    
+    return true;
+}
+
+struct TestSettingsResource {
+    float gravity = -9.81f;
+    int iterations = 4;
+};
+
+bool TestWorldResources() {
+    World world;
+    ASSERT_FALSE(world.HasResource<TestSettingsResource>());
+    ASSERT_TRUE(world.TryGetResource<TestSettingsResource>() == nullptr);
+    
+    bool threw = false;
+    try {
+        world.GetResource<TestSettingsResource>();
+    } catch (const std::runtime_error&) {
+        threw = true;
+    }
+    ASSERT_TRUE(threw);
+    
+    TestSettingsResource& settings = world.SetResource(TestSettingsResource{ -1.0f, 8 });
+    world.SetResource(TestComponent(5));
+    ASSERT_TRUE(world.HasResource<TestSettingsResource>());
+    ASSERT_EQ(world.GetResource<TestSettingsResource>().iterations, 8);
+    ASSERT_EQ(world.GetResource<TestComponent>().GetValue(), 5);
+    
+    // replacing assigns in place, so references handed out earlier see the new value
+    world.SetResource(TestSettingsResource{ -2.0f, 16 });
+    ASSERT_EQ(settings.iterations, 16);
+    ASSERT_TRUE(&world.GetResource<TestSettingsResource>() == &settings);
+    
+    // const overloads let read-only code look resources up through a const World
+    const World& readOnly = world;
+    ASSERT_TRUE(readOnly.HasResource<TestSettingsResource>());
+    ASSERT_TRUE(readOnly.TryGetResource<TestSettingsResource>() == &settings);
+    ASSERT_EQ(readOnly.GetResource<TestSettingsResource>().iterations, 16);
+    
+    // resources are per World and are not entities
+    World other;
+    ASSERT_FALSE(other.HasResource<TestSettingsResource>());
+    ASSERT_EQ(world.GetEntityCount(), 0u);
+    
+    world.RemoveResource<TestSettingsResource>();
+    ASSERT_FALSE(world.HasResource<TestSettingsResource>());
+    ASSERT_TRUE(world.HasResource<TestComponent>());
+    
+    return true;
+}
+
+bool TestPhysicsGroup() {
+    World world;
+    world.SetResource(Physics2DSettings{ glm::vec2(0.0f, -10.0f) });
+    auto physics = world.RegisterSystem<Physics2DSystem>();
+    physics->SetWorld(&world);
+    
+    Entity body = world.CreateEntity();
+    world.AddComponent(body, Transform2D(glm::vec2(0.0f, 0.0f)));
+    world.AddComponent(body, Rigidbody2D(1.0f));
+    world.AddComponent(body, BoxCollider2D(glm::vec2(1.0f, 1.0f)));
+    world.ecs_flush();
+    
+    // the group is built in SetWorld, so stepping does not register or reorder anything
+    Tick before = world.AdvanceTick();
+    world.FixedUpdate(0.5f);
+    world.FixedUpdate(0.5f);
+    ASSERT_TRUE(world.GetComponent<Transform2D>(body).position.y < 0.0f);
+    ASSERT_TRUE(world.GetComponent<Rigidbody2D>(body).velocity.y < 0.0f);
+    
+    // colliders are owned read-only: integration stamps the body, not its collider
+    ASSERT_TRUE(world.HasChangedSince<Rigidbody2D>(body, before));
+    ASSERT_FALSE(world.HasChangedSince<BoxCollider2D>(body, before));
+    
+    // gravity accessors forward to the Physics2DSettings resource
+    ASSERT_TRUE(physics->GetGravity() == glm::vec2(0.0f, -10.0f));
+    physics->SetGravity(glm::vec2(0.0f, 5.0f));
+    ASSERT_TRUE(world.GetResource<Physics2DSettings>().gravity == glm::vec2(0.0f, 5.0f));
+    world.RemoveResource<Physics2DSettings>();
+    ASSERT_TRUE(physics->GetGravity() == Physics2DSettings().gravity);
+    physics->SetGravity(glm::vec2(1.0f, 0.0f));
+    ASSERT_TRUE(world.HasResource<Physics2DSettings>());
+    ASSERT_TRUE(physics->GetGravity() == glm::vec2(1.0f, 0.0f));
+    
+    // the group owns its three types, so they can no longer be sorted or aligned
+    bool sortThrew = false;
+    try {
+        world.Sort<Transform2D>([](const Transform2D& a, const Transform2D& b) { return a.position.x < b.position.x; });
+    } catch (const std::runtime_error&) {
+        sortThrew = true;
+    }
+    ASSERT_TRUE(sortThrew);
+    
+    bool alignThrew = false;
+    try {
+        world.AlignTo<TestComponent, Rigidbody2D>();
+    } catch (const std::runtime_error&) {
+        alignThrew = true;
+    }
+    ASSERT_TRUE(alignThrew);
+    
+    return true;
+}
+
 void RunAllTests() {
     TestSuite ecsTestSuite("ECS System Tests");
     
@@ -177,6 +1817,34 @@ void RunAllTests() {
     ecsTestSuite.AddTest("Multiple Components", TestMultipleComponents);
     ecsTestSuite.AddTest("Entity Destruction", TestEntityDestruction);
     ecsTestSuite.AddTest("Pending Operation Count", TestPendingOperationCount);
+    ecsTestSuite.AddTest("Signature Matching", TestSignatureMatching);
+    ecsTestSuite.AddTest("Component Swap Remove", TestComponentSwapRemove);
+    ecsTestSuite.AddTest("Stale Entity Handle", TestStaleEntityHandle);
+    ecsTestSuite.AddTest("Archetype Storage", TestArchetypeStorage);
+    ecsTestSuite.AddTest("Command Buffer Batching", TestCommandBufferBatching);
+    ecsTestSuite.AddTest("Component View", TestComponentView);
+    ecsTestSuite.AddTest("Owning Group", TestOwningGroup);
+    ecsTestSuite.AddTest("System Reverse Index", TestSystemReverseIndex);
+    ecsTestSuite.AddTest("System Entity Set", TestSystemEntitySet);
+    ecsTestSuite.AddTest("System Scheduling", TestSystemScheduling);
+    ecsTestSuite.AddTest("Job System", TestJobSystem);
+    ecsTestSuite.AddTest("Job Exceptions", TestJobExceptions);
+    ecsTestSuite.AddTest("Parallel Each", TestParallelEach);
+    ecsTestSuite.AddTest("Thread Command Buffers", TestThreadCommandBuffers);
+    ecsTestSuite.AddTest("Deterministic Commands", TestDeterministicCommands);
+    ecsTestSuite.AddTest("Bulk Entities", TestBulkEntities);
+    ecsTestSuite.AddTest("Prefab Instantiate", TestPrefabInstantiate);
+    ecsTestSuite.AddTest("Pointer Stable Storage", TestPointerStableStorage);
+    ecsTestSuite.AddTest("POD Components", TestPodComponents);
+    ecsTestSuite.AddTest("Change Detection", TestChangeDetection);
+    ecsTestSuite.AddTest("Batched Observers", TestBatchedObservers);
+    ecsTestSuite.AddTest("Array Sorting", TestArraySorting);
+    ecsTestSuite.AddTest("Transform Hierarchy", TestTransformHierarchy);
+    ecsTestSuite.AddTest("World Snapshot", TestWorldSnapshot);
+    ecsTestSuite.AddTest("Rollback", TestRollback);
+    ecsTestSuite.AddTest("Fixed Timestep", TestFixedTimestep);
+    ecsTestSuite.AddTest("World Resources", TestWorldResources);
+    ecsTestSuite.AddTest("Physics Group", TestPhysicsGroup);
     
     auto results = ecsTestSuite.RunTests();
     ecsTestSuite.PrintSummary(results);
@@ -191,7 +1859,35 @@ bool RunSingleTest(const std::string& testName) {
         {"Component Removal", TestComponentRemoval},
         {"Multiple Components", TestMultipleComponents},
         {"Entity Destruction", TestEntityDestruction},
-        {"Pending Operation Count", TestPendingOperationCount}
+        {"Pending Operation Count", TestPendingOperationCount},
+        {"Signature Matching", TestSignatureMatching},
+        {"Component Swap Remove", TestComponentSwapRemove},
+        {"Stale Entity Handle", TestStaleEntityHandle},
+        {"Archetype Storage", TestArchetypeStorage},
+        {"Command Buffer Batching", TestCommandBufferBatching},
+        {"Component View", TestComponentView},
+        {"Owning Group", TestOwningGroup},
+        {"System Reverse Index", TestSystemReverseIndex},
+        {"System Entity Set", TestSystemEntitySet},
+        {"System Scheduling", TestSystemScheduling},
+        {"Job System", TestJobSystem},
+        {"Job Exceptions", TestJobExceptions},
+        {"Parallel Each", TestParallelEach},
+        {"Thread Command Buffers", TestThreadCommandBuffers},
+        {"Deterministic Commands", TestDeterministicCommands},
+        {"Bulk Entities", TestBulkEntities},
+        {"Prefab Instantiate", TestPrefabInstantiate},
+        {"Pointer Stable Storage", TestPointerStableStorage},
+        {"POD Components", TestPodComponents},
+        {"Change Detection", TestChangeDetection},
+        {"Batched Observers", TestBatchedObservers},
+        {"Array Sorting", TestArraySorting},
+        {"Transform Hierarchy", TestTransformHierarchy},
+        {"World Snapshot", TestWorldSnapshot},
+        {"Rollback", TestRollback},
+        {"Fixed Timestep", TestFixedTimestep},
+        {"World Resources", TestWorldResources},
+        {"Physics Group", TestPhysicsGroup}
     };
     
     auto it = testMap.find(testName);